@@ -0,0 +1,56 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+
+#include "PrvBakeGroundGridCommandlet.generated.h"
+
+struct FPrvGroundCell;
+
+/**
+ * Bakes static ground of the map into grid used by vehicles on dedicated servers.
+ *
+ * Usage: UE4Editor-Cmd.exe <Project> -run=PrvBakeGroundGrid -Map=/Game/Maps/MyMap
+ *   [-CellSize=50] [-TileCells=64] [-Layers=2] [-LayerClearance=250] [-TraceTypeQuery=0] [-TraceComplex] [-Output=<File>]
+ *
+ * Output goes to Content/PrvGroundGrid/<MapName>.prvgrid by default. Add this directory
+ * to "Additional Non-Asset Directories to Package" so it's shipped with the server.
+ */
+UCLASS()
+class UPrvBakeGroundGridCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+	// UCommandlet interface
+	virtual int32 Main(const FString& Params) override;
+	// End of UCommandlet interface
+
+protected:
+	/** Trace all ground layers at the location from top to bottom */
+	void BakeCell(UWorld* World, float X, float Y, float TopZ, float BottomZ, FPrvGroundCell* OutLayers);
+
+	/** Index of physical material in materials table */
+	uint8 GetMaterialIndex(const UPhysicalMaterial* PhysMaterial);
+
+	/** Size of a single cell [cm] */
+	float CellSize;
+
+	/** Number of cells along tile side */
+	int32 TileCells;
+
+	/** Ground layers per cell */
+	int32 Layers;
+
+	/** Min vertical distance between two ground layers [cm] */
+	float LayerClearance;
+
+	/** Trace channel to bake */
+	ECollisionChannel TraceChannel;
+
+	/** Trace complex collision */
+	bool bTraceComplex;
+
+	/** Physical materials of baked ground */
+	TArray<const UPhysicalMaterial*> Materials;
+};
@@ -0,0 +1,257 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#include "PrvBakeGroundGridCommandlet.h"
+
+#include "PrvEditorPlugin.h"
+#include "PrvGroundGrid.h"
+
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/PackageName.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+#include "UObject/UObjectIterator.h"
+
+UPrvBakeGroundGridCommandlet::UPrvBakeGroundGridCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+
+	CellSize = 50.f;
+	TileCells = 64;
+	Layers = 2;
+	LayerClearance = 250.f;
+	TraceChannel = ECC_Visibility;
+	bTraceComplex = false;
+}
+
+int32 UPrvBakeGroundGridCommandlet::Main(const FString& Params)
+{
+	FString MapPackageName;
+	if (!FParse::Value(*Params, TEXT("Map="), MapPackageName))
+	{
+		UE_LOG(LogPrvVehicleEditor, Error, TEXT("PrvBakeGroundGrid: -Map=<Package> is required"));
+		return 1;
+	}
+
+	int32 TraceTypeQuery = 0;
+	FParse::Value(*Params, TEXT("CellSize="), CellSize);
+	FParse::Value(*Params, TEXT("TileCells="), TileCells);
+	FParse::Value(*Params, TEXT("Layers="), Layers);
+	FParse::Value(*Params, TEXT("LayerClearance="), LayerClearance);
+	FParse::Value(*Params, TEXT("TraceTypeQuery="), TraceTypeQuery);
+	bTraceComplex = FParse::Param(*Params, TEXT("TraceComplex"));
+
+	CellSize = FMath::Max(1.f, CellSize);
+	TileCells = FMath::Clamp(TileCells, 1, 1024);
+	Layers = FMath::Clamp(Layers, 1, 16);
+	TraceChannel = UEngineTypes::ConvertToCollisionChannel(static_cast<ETraceTypeQuery>(FMath::Clamp(TraceTypeQuery, 0, static_cast<int32>(TraceTypeQuery_MAX) - 1)));
+
+	FString OutputPath = FPrvGroundGrid::GetGridFilePath(FPackageName::GetShortName(MapPackageName));
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	// Load the map with collision only
+	UPackage* MapPackage = LoadPackage(nullptr, *MapPackageName, LOAD_None);
+	UWorld* World = MapPackage ? UWorld::FindWorldInPackage(MapPackage) : nullptr;
+	if (World == nullptr)
+	{
+		UE_LOG(LogPrvVehicleEditor, Error, TEXT("PrvBakeGroundGrid: Can't load map %s"), *MapPackageName);
+		return 1;
+	}
+
+	World->AddToRoot();
+	World->WorldType = EWorldType::Editor;
+	GWorld = World;
+
+	World->InitWorld(UWorld::InitializationValues()
+						 .ShouldSimulatePhysics(false)
+						 .EnableTraceCollision(true)
+						 .CreateNavigation(false)
+						 .CreateAISystem(false)
+						 .AllowAudioPlayback(false)
+						 .CreatePhysicsScene(true));
+	World->LoadSecondaryLevels(true);
+	World->UpdateWorldComponents(true, false);
+
+	// Grid covers all static geometry that blocks suspension traces
+	FBox GroundBounds(ForceInit);
+	for (TObjectIterator<UPrimitiveComponent> It; It; ++It)
+	{
+		const UPrimitiveComponent* Component = *It;
+		if (Component->GetWorld() == World && Component->IsRegistered() && Component->Mobility == EComponentMobility::Static &&
+			Component->IsQueryCollisionEnabled() && Component->GetCollisionResponseToChannel(TraceChannel) == ECR_Block)
+		{
+			GroundBounds += Component->Bounds.GetBox();
+		}
+	}
+
+	if (!GroundBounds.IsValid)
+	{
+		UE_LOG(LogPrvVehicleEditor, Error, TEXT("PrvBakeGroundGrid: No static ground found in %s"), *MapPackageName);
+		World->RemoveFromRoot();
+		return 1;
+	}
+
+	const float TileSize = CellSize * TileCells;
+
+	FPrvGroundGridHeader Header;
+	Header.OriginX = GroundBounds.Min.X;
+	Header.OriginY = GroundBounds.Min.Y;
+	Header.CellSize = CellSize;
+	Header.TileCells = TileCells;
+	Header.TilesX = FMath::Max(1, FMath::CeilToInt((GroundBounds.Max.X - GroundBounds.Min.X) / TileSize));
+	Header.TilesY = FMath::Max(1, FMath::CeilToInt((GroundBounds.Max.Y - GroundBounds.Min.Y) / TileSize));
+	Header.Layers = Layers;
+
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*OutputPath));
+	if (!Writer.IsValid())
+	{
+		UE_LOG(LogPrvVehicleEditor, Error, TEXT("PrvBakeGroundGrid: Can't write %s"), *OutputPath);
+		World->RemoveFromRoot();
+		return 1;
+	}
+
+	// Header and tile offsets are written when all tiles are baked
+	TArray<int64> TileOffsets;
+	TileOffsets.SetNumZeroed(Header.GetTilesNum());
+
+	TArray<uint8> Placeholder;
+	Placeholder.SetNumZeroed(Header.GetTileOffsetsOffset() + TileOffsets.Num() * sizeof(int64));
+	Writer->Serialize(Placeholder.GetData(), Placeholder.Num());
+
+	TArray<FPrvGroundCell> TileData;
+	TileData.SetNum(Header.GetTileSamplesNum());
+
+	const float TopZ = GroundBounds.Max.Z + 100.f;
+	const float BottomZ = GroundBounds.Min.Z - 100.f;
+	int32 StoredTiles = 0;
+
+	for (int32 TileY = 0; TileY < Header.TilesY; ++TileY)
+	{
+		for (int32 TileX = 0; TileX < Header.TilesX; ++TileX)
+		{
+			bool bTileHasGround = false;
+
+			for (int32 CellY = 0; CellY < TileCells; ++CellY)
+			{
+				for (int32 CellX = 0; CellX < TileCells; ++CellX)
+				{
+					const float X = Header.OriginX + ((TileX * TileCells + CellX) + 0.5f) * CellSize;
+					const float Y = Header.OriginY + ((TileY * TileCells + CellY) + 0.5f) * CellSize;
+
+					FPrvGroundCell* CellLayers = &TileData[(CellY * TileCells + CellX) * Layers];
+					BakeCell(World, X, Y, TopZ, BottomZ, CellLayers);
+
+					bTileHasGround |= CellLayers[0].IsValid();
+				}
+			}
+
+			// Empty tiles aren't stored
+			if (bTileHasGround)
+			{
+				TileOffsets[TileY * Header.TilesX + TileX] = Writer->Tell();
+				Writer->Serialize(TileData.GetData(), Header.GetTileDataSize());
+				StoredTiles++;
+			}
+		}
+
+		UE_LOG(LogPrvVehicleEditor, Display, TEXT("PrvBakeGroundGrid: Tile row %d/%d baked"), TileY + 1, Header.TilesY);
+	}
+
+	// Physical materials table
+	TArray<FString> MaterialPaths;
+	for (const UPhysicalMaterial* PhysMaterial : Materials)
+	{
+		MaterialPaths.Add(PhysMaterial->GetPathName());
+	}
+
+	Header.MaterialsNum = MaterialPaths.Num();
+	Header.MaterialsOffset = Writer->Tell();
+	*Writer << MaterialPaths;
+
+	Writer->Seek(0);
+	Writer->Serialize(&Header, sizeof(FPrvGroundGridHeader));
+	Writer->Serialize(TileOffsets.GetData(), TileOffsets.Num() * sizeof(int64));
+
+	const bool bWritten = Writer->Close();
+	Writer.Reset();
+
+	World->RemoveFromRoot();
+
+	if (!bWritten)
+	{
+		UE_LOG(LogPrvVehicleEditor, Error, TEXT("PrvBakeGroundGrid: Failed to write %s"), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogPrvVehicleEditor, Display, TEXT("PrvBakeGroundGrid: %s baked to %s (%d of %d tiles stored, %d materials)"), *MapPackageName, *OutputPath, StoredTiles, Header.GetTilesNum(), Materials.Num());
+
+	return 0;
+}
+
+void UPrvBakeGroundGridCommandlet::BakeCell(UWorld* World, float X, float Y, float TopZ, float BottomZ, FPrvGroundCell* OutLayers)
+{
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(PrvBakeGroundGrid), bTraceComplex);
+	QueryParams.bReturnPhysicalMaterial = true;
+
+	// Limit retries on dynamic geometry stacked above the ground
+	int32 TracesLeft = Layers * 4;
+
+	float StartZ = TopZ;
+	int32 LayerIdx = 0;
+	while (LayerIdx < Layers && StartZ > BottomZ && TracesLeft-- > 0)
+	{
+		FHitResult Hit;
+		if (!World->LineTraceSingleByChannel(Hit, FVector(X, Y, StartZ), FVector(X, Y, BottomZ), TraceChannel, QueryParams))
+		{
+			break;
+		}
+
+		// Only static ground can be baked, dynamic objects are traced at runtime
+		UPrimitiveComponent* HitComponent = Hit.Component.Get();
+		if (HitComponent && HitComponent->Mobility != EComponentMobility::Static)
+		{
+			QueryParams.AddIgnoredComponent(HitComponent);
+			continue;
+		}
+
+		FPrvGroundCell& Cell = OutLayers[LayerIdx++];
+		Cell.Height = Hit.ImpactPoint.Z;
+		Cell.SetNormal(Hit.ImpactNormal);
+		Cell.SurfaceType = static_cast<uint8>(UGameplayStatics::GetSurfaceType(Hit));
+		Cell.MaterialIndex = GetMaterialIndex(Hit.PhysMaterial.Get());
+
+		// Next layer should have enough space for vehicle
+		StartZ = Hit.ImpactPoint.Z - LayerClearance;
+	}
+
+	for (; LayerIdx < Layers; ++LayerIdx)
+	{
+		OutLayers[LayerIdx] = FPrvGroundCell();
+	}
+}
+
+uint8 UPrvBakeGroundGridCommandlet::GetMaterialIndex(const UPhysicalMaterial* PhysMaterial)
+{
+	if (PhysMaterial == nullptr)
+	{
+		return FPrvGroundCell::NoMaterial;
+	}
+
+	int32 MaterialIndex = Materials.Find(PhysMaterial);
+	if (MaterialIndex == INDEX_NONE)
+	{
+		if (Materials.Num() >= FPrvGroundCell::NoMaterial)
+		{
+			return FPrvGroundCell::NoMaterial;
+		}
+
+		MaterialIndex = Materials.Add(PhysMaterial);
+	}
+
+	return static_cast<uint8>(MaterialIndex);
+}
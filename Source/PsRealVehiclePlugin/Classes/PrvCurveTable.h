@@ -0,0 +1,59 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Curves/RichCurve.h"
+
+/**
+ * Float curve baked into uniformly sampled values with linear lookup.
+ * Covers the curve keys range, constant extrapolation is applied outside of it.
+ * Tables are immutable and shared between all vehicles with identical curves.
+ */
+struct FPrvCurveTable
+{
+	/** Time of the first sample */
+	float MinTime;
+
+	/** 1 / sample step */
+	float InvStep;
+
+	/** Max absolute difference with the source curve found on bake */
+	float MaxError;
+
+	/** Value range of the source curve (to make error relative) */
+	float ValueRange;
+
+	/** Uniform samples, at least two */
+	TArray<float> Values;
+
+	/** Keys of the source curve (to find identical curves) */
+	TArray<FRichCurveKey> SourceKeys;
+
+	/** Number of steps requested on bake */
+	int32 Resolution;
+
+	FPrvCurveTable()
+		: MinTime(0.f)
+		, InvStep(0.f)
+		, MaxError(0.f)
+		, ValueRange(0.f)
+		, Resolution(0)
+	{
+	}
+
+	/** Interpolated curve value */
+	FORCEINLINE float Eval(float Time) const
+	{
+		const int32 LastIndex = Values.Num() - 1;
+		const float Position = FMath::Clamp((Time - MinTime) * InvStep, 0.f, static_cast<float>(LastIndex));
+		const int32 Index = FMath::Min(FMath::TruncToInt(Position), LastIndex - 1);
+		return FMath::Lerp(Values[Index], Values[Index + 1], Position - Index);
+	}
+
+	/**
+	 * Get the table of the curve with given number of steps, baked on first request.
+	 * Returns nullptr if curve can't be baked (extrapolation other than constant).
+	 */
+	static TSharedPtr<const FPrvCurveTable> FindOrBake(const FRichCurve& Curve, int32 Resolution);
+};
@@ -0,0 +1,50 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Discrete damping correction of suspension.
+ * Both corrections don't depend on suspension velocity: custom correction scales the velocity
+ * by a factor of (stiffness, damping, mass, DeltaTime), and adaptive correction scales the damping
+ * by g(x) = (1 - exp(-x)) / x of a single argument. So they are tabulated once and interpolated per wheel.
+ */
+struct FPrvDampingCorrection
+{
+	/** Closed form of custom correction: corrected velocity = velocity * scale */
+	static float CalcVelocityScale(float Stiffness, float Damping, float Mass, float DeltaTime, float CorrectionFactor);
+
+	/** Closed form of adaptive correction: corrected damping = damping * scale */
+	static float CalcAdaptiveDampingScale(float Damping, float Mass, int32 ActiveWheelsNum, float DeltaTime);
+
+	/** Adaptive correction from the shared table */
+	static float GetAdaptiveDampingScale(float Damping, float Mass, int32 ActiveWheelsNum, float DeltaTime);
+};
+
+/** Custom damping correction of one (stiffness, damping) pair tabulated over DeltaTime */
+struct FPrvDampingCorrectionTable
+{
+	/** Max DeltaTime covered by tables (suspension clamps DeltaTime to this) */
+	static constexpr float MaxDeltaTime = 1.f / 15.f;
+
+	/** Number of DeltaTime steps */
+	static constexpr int32 Resolution = 1024;
+
+	float Stiffness;
+	float Damping;
+
+	/** Velocity scale for each DeltaTime step */
+	TArray<float> VelocityScale;
+
+	FPrvDampingCorrectionTable()
+		: Stiffness(0.f)
+		, Damping(0.f)
+	{
+	}
+
+	void Build(float InStiffness, float InDamping, float Mass, float CorrectionFactor);
+
+	/** Interpolated custom correction velocity scale */
+	float GetVelocityScale(float DeltaTime) const;
+};
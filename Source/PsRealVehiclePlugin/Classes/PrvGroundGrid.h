@@ -0,0 +1,164 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+class UPhysicalMaterial;
+
+/**
+ * Baked ground grid file layout:
+ * [Header][Tile offsets: int64 * TilesNum][Tiles: FPrvGroundCell * TileCells^2 * Layers][Materials table]
+ * Tile cells are stored row by row, each cell keeps its layers from top to bottom.
+ * Empty tiles have zero offset and aren't stored at all.
+ */
+struct FPrvGroundGridHeader
+{
+	static const uint32 FileMagic = 0x44475250; // PRGD
+	static const uint32 FileVersion = 1;
+
+	uint32 Magic;
+	uint32 Version;
+
+	/** World position of grid corner */
+	float OriginX;
+	float OriginY;
+
+	/** Size of a single cell [cm] */
+	float CellSize;
+
+	/** Number of cells along tile side */
+	int32 TileCells;
+
+	/** Number of tiles along grid sides */
+	int32 TilesX;
+	int32 TilesY;
+
+	/** Ground layers per cell (bridges, tunnels) */
+	int32 Layers;
+
+	/** Number of physical materials in materials table */
+	int32 MaterialsNum;
+
+	/** Offset of physical materials table (serialized array of object paths) */
+	int64 MaterialsOffset;
+
+	FPrvGroundGridHeader()
+		: Magic(FileMagic)
+		, Version(FileVersion)
+		, OriginX(0.f)
+		, OriginY(0.f)
+		, CellSize(100.f)
+		, TileCells(64)
+		, TilesX(0)
+		, TilesY(0)
+		, Layers(1)
+		, MaterialsNum(0)
+		, MaterialsOffset(0)
+	{
+	}
+
+	int32 GetTilesNum() const { return TilesX * TilesY; }
+	int32 GetTileSamplesNum() const { return TileCells * TileCells * Layers; }
+	int64 GetTileDataSize() const;
+	int64 GetTileOffsetsOffset() const { return sizeof(FPrvGroundGridHeader); }
+};
+
+/** Single ground layer sample of the baked grid */
+struct FPrvGroundCell
+{
+	/** Cell has no ground on this layer */
+	static const uint8 InvalidMaterial = 0xFF;
+
+	/** Ground has no physical material */
+	static const uint8 NoMaterial = 0xFE;
+
+	/** World height of the ground */
+	float Height;
+
+	/** Quantized ground normal (Z is restored, normal always points up) */
+	int8 NormalX;
+	int8 NormalY;
+
+	/** EPhysicalSurface of the ground */
+	uint8 SurfaceType;
+
+	/** Index in grid materials table */
+	uint8 MaterialIndex;
+
+	FPrvGroundCell()
+		: Height(0.f)
+		, NormalX(0)
+		, NormalY(0)
+		, SurfaceType(0)
+		, MaterialIndex(InvalidMaterial)
+	{
+	}
+
+	bool IsValid() const { return MaterialIndex != InvalidMaterial; }
+
+	FVector GetNormal() const;
+	void SetNormal(const FVector& Normal);
+};
+
+static_assert(sizeof(FPrvGroundCell) == 8, "FPrvGroundCell is a part of the file format");
+
+/** Memory mapped baked ground grid with lazily paged tiles */
+class PSREALVEHICLEPLUGIN_API FPrvGroundGrid
+{
+public:
+	FPrvGroundGrid();
+	~FPrvGroundGrid();
+
+	/** Map grid file. Tiles are mapped on demand */
+	bool Open(const FString& FilePath);
+
+	/** Unmap all tiles and close the file */
+	void Close();
+
+	bool IsOpen() const { return FileHandle.IsValid(); }
+
+	/** Find the top ground layer under the location */
+	bool Sample(const FVector& Location, FVector& OutPoint, FVector& OutNormal, uint8& OutSurfaceType, UPhysicalMaterial*& OutPhysMaterial);
+
+	/** Limit of tiles kept mapped at once */
+	void SetMaxResidentTiles(int32 InMaxResidentTiles);
+
+	int32 GetResidentTilesNum() const { return ResidentTiles.Num(); }
+
+	/** Physical materials referenced by the grid (should be kept from GC by the owner) */
+	const TArray<UPhysicalMaterial*>& GetMaterials() const { return Materials; }
+
+	/** Default location of the grid baked for the map */
+	static FString GetGridFilePath(const FString& MapName);
+
+private:
+	/** Map tile on demand, returns nullptr for empty tile */
+	const FPrvGroundCell* GetTileCells(int32 TileIndex);
+
+	/** Unmap least recently used tiles over the budget */
+	void TrimResidentTiles(int32 MaxTiles);
+
+	struct FResidentTile
+	{
+		TUniquePtr<IMappedFileRegion> Region;
+		uint64 LastUsedFrame;
+	};
+
+	TUniquePtr<IMappedFileHandle> FileHandle;
+
+	FPrvGroundGridHeader Header;
+
+	/** File offset of each tile data (zero for empty tile) */
+	TArray<int64> TileOffsets;
+
+	/** Materials of the materials table */
+	TArray<UPhysicalMaterial*> Materials;
+
+	/** Currently mapped tiles */
+	TMap<int32, FResidentTile> ResidentTiles;
+
+	int32 MaxResidentTiles;
+};
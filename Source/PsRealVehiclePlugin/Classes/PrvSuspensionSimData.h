@@ -0,0 +1,114 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Hot per-wheel suspension data laid out as structure of arrays.
+ * Indices match vehicle SuspensionData, which keeps cold config and cosmetic state
+ * and is refreshed from these arrays as a view for Blueprints and animation.
+ */
+struct FPrvSuspensionSimData
+{
+	//////////////////////////////////////////////////////////////////////////
+	// Config (global factors applied)
+
+	/** Effective suspension length */
+	TArray<float> Length;
+
+	/** 1 / Length */
+	TArray<float> InvLength;
+
+	/** Spring stiffness */
+	TArray<float> Stiffness;
+
+	/** Damping when the spring is compressed */
+	TArray<float> CompressionDamping;
+
+	/** Damping when the spring is decompressed */
+	TArray<float> DecompressionDamping;
+
+	/** Damping correction table of compression */
+	TArray<int32> CompressionCorrectionTable;
+
+	/** Damping correction table of decompression */
+	TArray<int32> DecompressionCorrectionTable;
+
+	//////////////////////////////////////////////////////////////////////////
+	// Probe
+
+	/** World space probe start */
+	TArray<FVector> ProbeOrigin;
+
+	/** World space suspension up vector */
+	TArray<FVector> ProbeDirection;
+
+	//////////////////////////////////////////////////////////////////////////
+	// Contact
+
+	/** Wheel has valid ground contact on this tick */
+	TArray<uint8> Contact;
+
+	/** Suspension length clamped to [0; Length] on this tick */
+	TArray<float> ContactLength;
+
+	TArray<FVector> ContactLocation;
+	TArray<FVector> ContactNormal;
+
+	//////////////////////////////////////////////////////////////////////////
+	// State
+
+	/** Effective suspension length on last tick */
+	TArray<float> PreviousLength;
+
+	/** Spring-damper force along the suspension direction */
+	TArray<float> Force;
+
+	/** Load on the wheel contact */
+	TArray<float> Load;
+
+	//////////////////////////////////////////////////////////////////////////
+	// Spring-damper intermediates
+
+	/** Spring compression ratio [0; 1] */
+	TArray<float> Compression;
+
+	/** Suspension velocity (damping correction can change it) */
+	TArray<float> Velocity;
+
+	/** Damping selected by velocity direction (damping correction can change it) */
+	TArray<float> Damping;
+
+	int32 Num() const
+	{
+		return Length.Num();
+	}
+
+	void SetNum(int32 WheelsNum)
+	{
+		Length.SetNumZeroed(WheelsNum);
+		InvLength.SetNumZeroed(WheelsNum);
+		Stiffness.SetNumZeroed(WheelsNum);
+		CompressionDamping.SetNumZeroed(WheelsNum);
+		DecompressionDamping.SetNumZeroed(WheelsNum);
+		CompressionCorrectionTable.SetNumZeroed(WheelsNum);
+		DecompressionCorrectionTable.SetNumZeroed(WheelsNum);
+
+		ProbeOrigin.SetNumZeroed(WheelsNum);
+		ProbeDirection.SetNumZeroed(WheelsNum);
+
+		Contact.SetNumZeroed(WheelsNum);
+		ContactLength.SetNumZeroed(WheelsNum);
+		ContactLocation.SetNumZeroed(WheelsNum);
+		ContactNormal.SetNumZeroed(WheelsNum);
+
+		PreviousLength.SetNumZeroed(WheelsNum);
+		Force.SetNumZeroed(WheelsNum);
+		Load.SetNumZeroed(WheelsNum);
+
+		Compression.SetNumZeroed(WheelsNum);
+		Velocity.SetNumZeroed(WheelsNum);
+		Damping.SetNumZeroed(WheelsNum);
+	}
+};
@@ -7,6 +7,10 @@
 #include "Particles/ParticleSystemComponent.h"
 #include "AI/Navigation/NavigationAvoidanceTypes.h"
 #include "AI/RVOAvoidanceInterface.h"
+#include "PrvCurveTable.h"
+#include "PrvDampingCorrection.h"
+#include "PrvSuspensionSimData.h"
+#include "PrvVehicleSubsystem.h"
 #include "PrvVehicleMovementComponent.generated.h"
 
 
@@ -213,6 +217,247 @@ struct FSuspensionInfo
 	}
 };
 
+/** World space geometry of a single wheel probe */
+struct FPrvWheelProbe
+{
+	/** Top of the suspension */
+	FVector Start;
+
+	/** Bottom of the suspension including MaxDrop */
+	FVector End;
+
+	/** Suspension up vector in world space */
+	FVector UpVector;
+
+	/** Wheel collision radius */
+	float Radius;
+
+	/** Probe should be made with line trace */
+	bool bLineTrace;
+
+	/** Wheel has collision width */
+	bool bCylinder;
+
+	/** Cylindrical wheel is probed with a single box sweep instead of multi sphere sweep */
+	bool bBoxSweep;
+
+	/** Wheel rotation in world space */
+	FQuat Rotation;
+
+	/** Half of wheel collision width */
+	float HalfWidth;
+
+	/** Vehicle mesh transform the probe was made for */
+	FTransform MeshTransform;
+
+	FPrvWheelProbe()
+		: Start(FVector::ZeroVector)
+		, End(FVector::ZeroVector)
+		, UpVector(FVector::UpVector)
+		, Radius(0.f)
+		, bLineTrace(false)
+		, bCylinder(false)
+		, bBoxSweep(false)
+		, Rotation(FQuat::Identity)
+		, HalfWidth(0.f)
+		, MeshTransform(FTransform::Identity)
+	{
+	}
+
+	/** Shape to sweep */
+	FCollisionShape GetShape() const
+	{
+		return bBoxSweep ? FCollisionShape::MakeBox(FVector(Radius, HalfWidth, Radius)) : FCollisionShape::MakeSphere(Radius);
+	}
+
+	/** Rotation of the swept shape */
+	FQuat GetShapeRotation() const
+	{
+		return bBoxSweep ? Rotation : FQuat::Identity;
+	}
+};
+
+/** Ground under the track sampled along its length */
+struct FPrvTrackProfile
+{
+	/** Mesh space X of the first and the last samples */
+	float MinX;
+	float MaxX;
+
+	/** Ground point of each sample */
+	TArray<FVector> Points;
+
+	/** Ground normal of each sample */
+	TArray<FVector> Normals;
+
+	/** Ground primitive of each sample */
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> Components;
+
+	/** Ground physical material of each sample */
+	TArray<TWeakObjectPtr<UPhysicalMaterial>> PhysMaterials;
+
+	/** Sample has found the ground */
+	TArray<bool> ValidSamples;
+
+	/** Profile was sampled on this tick */
+	bool bActive;
+
+	FPrvTrackProfile()
+		: MinX(0.f)
+		, MaxX(0.f)
+		, bActive(false)
+	{
+	}
+};
+
+/** Rigid body state read from physics once per tick and shared by all simulation stages */
+struct FPrvBodySnapshot
+{
+	FTransform ComponentTransform;
+
+	/** Owner actor transform (custom wheel velocity is calculated in actor space) */
+	FTransform OwnerTransform;
+
+	FVector ForwardVector;
+	FVector RightVector;
+	FVector UpVector;
+
+	FVector LinearVelocity;
+	FVector AngularVelocityInDegrees;
+
+	/** World space center of mass */
+	FVector CenterOfMass;
+
+	float Mass;
+	float GravityZ;
+
+	/** Vehicle is simulated locally and should push forces to physics */
+	bool bAddForce;
+
+	FPrvBodySnapshot()
+		: ComponentTransform(FTransform::Identity)
+		, OwnerTransform(FTransform::Identity)
+		, ForwardVector(FVector::ForwardVector)
+		, RightVector(FVector::RightVector)
+		, UpVector(FVector::UpVector)
+		, LinearVelocity(FVector::ZeroVector)
+		, AngularVelocityInDegrees(FVector::ZeroVector)
+		, CenterOfMass(FVector::ZeroVector)
+		, Mass(0.f)
+		, GravityZ(0.f)
+		, bAddForce(false)
+	{
+	}
+
+	/** Signed speed along the forward vector */
+	float GetForwardSpeed() const
+	{
+		const float VelocityDirection = FVector::DotProduct(ForwardVector, LinearVelocity);
+		return LinearVelocity.Size() * ((VelocityDirection >= 0.f) ? 1.f : -1.f);
+	}
+
+	/** World space velocity of the body point */
+	FVector GetVelocityAtPoint(const FVector& Point) const
+	{
+		return LinearVelocity + FVector::CrossProduct(FMath::DegreesToRadians(AngularVelocityInDegrees), Point - CenterOfMass);
+	}
+
+	/** Predict the body pose after given time with constant velocities */
+	void Advance(float Time)
+	{
+		const FVector Offset = LinearVelocity * Time;
+		const FVector AngularVelocity = FMath::DegreesToRadians(AngularVelocityInDegrees);
+		const float Angle = AngularVelocity.Size() * Time;
+		const FQuat DeltaRotation = (Angle > SMALL_NUMBER) ? FQuat(AngularVelocity.GetSafeNormal(), Angle) : FQuat::Identity;
+
+		// Body rotates about its center of mass
+		ComponentTransform.SetLocation(CenterOfMass + Offset + DeltaRotation.RotateVector(ComponentTransform.GetLocation() - CenterOfMass));
+		ComponentTransform.SetRotation(DeltaRotation * ComponentTransform.GetRotation());
+		OwnerTransform.SetLocation(CenterOfMass + Offset + DeltaRotation.RotateVector(OwnerTransform.GetLocation() - CenterOfMass));
+		OwnerTransform.SetRotation(DeltaRotation * OwnerTransform.GetRotation());
+
+		ForwardVector = DeltaRotation.RotateVector(ForwardVector);
+		RightVector = DeltaRotation.RotateVector(RightVector);
+		UpVector = DeltaRotation.RotateVector(UpVector);
+		CenterOfMass += Offset;
+	}
+};
+
+/** Net force and torque collected from all simulation stages to be applied to the body once per tick */
+struct FPrvForceAccumulator
+{
+	/** Net force applied at the center of mass */
+	FVector Force;
+
+	/** Net torque about the center of mass (radians) */
+	FVector Torque;
+
+	/** World space center of mass the torque is calculated about */
+	FVector CenterOfMass;
+
+	/** Angular velocity override requested by steering */
+	FVector AngularVelocityInDegrees;
+	bool bSetAngularVelocity;
+
+	FPrvForceAccumulator()
+		: Force(FVector::ZeroVector)
+		, Torque(FVector::ZeroVector)
+		, CenterOfMass(FVector::ZeroVector)
+		, AngularVelocityInDegrees(FVector::ZeroVector)
+		, bSetAngularVelocity(false)
+	{
+	}
+
+	void Reset(const FVector& InCenterOfMass)
+	{
+		Force = FVector::ZeroVector;
+		Torque = FVector::ZeroVector;
+		CenterOfMass = InCenterOfMass;
+		AngularVelocityInDegrees = FVector::ZeroVector;
+		bSetAngularVelocity = false;
+	}
+
+	void AddForce(const FVector& InForce)
+	{
+		Force += InForce;
+	}
+
+	void AddForceAtLocation(const FVector& InForce, const FVector& Location)
+	{
+		Force += InForce;
+		Torque += FVector::CrossProduct(Location - CenterOfMass, InForce);
+	}
+
+	void AddTorqueInRadians(const FVector& InTorque)
+	{
+		Torque += InTorque;
+	}
+
+	void SetAngularVelocityInDegrees(const FVector& InAngularVelocity)
+	{
+		AngularVelocityInDegrees = InAngularVelocity;
+		bSetAngularVelocity = true;
+	}
+};
+
+/** Wheel visuals at the last two fixed simulation steps, rendered state is interpolated between them */
+struct FPrvFixedStepWheelVisuals
+{
+	float PreviousVisualLength;
+	float VisualLength;
+
+	float PreviousRotationAngle;
+	float RotationAngle;
+
+	FPrvFixedStepWheelVisuals()
+		: PreviousVisualLength(0.f)
+		, VisualLength(0.f)
+		, PreviousRotationAngle(0.f)
+		, RotationAngle(0.f)
+	{
+	}
+};
+
 USTRUCT(BlueprintType)
 struct FSuspensionState
 {
@@ -242,6 +487,10 @@ struct FSuspensionState
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
 	FVector SuspensionForce;
 
+	/** Drive and friction force applied at the wheel contact on last tick */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
+	FVector FrictionForce;
+
 	/**  */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
 	FVector WheelCollisionLocation;
@@ -270,6 +519,36 @@ struct FSuspensionState
 	UPROPERTY(Transient)
 	UParticleSystemComponent* DustPSC;
 
+	/** Async probe queued into vehicle subsystem on last tick */
+	FPrvProbeTicket ProbeTicket;
+
+	/** Queued probe was made with line trace */
+	bool bProbeTicketLineTrace;
+
+	/** Last probe result that can be reused while the wheel stays in place */
+	FHitResult CoherentHit;
+
+	/** Probe origin the coherent hit was found from */
+	FVector CoherentProbeStart;
+
+	/** Probe direction the coherent hit was found with */
+	FVector CoherentProbeUpVector;
+
+	/** Frames left before the coherent hit should be revalidated */
+	int32 CoherentFramesLeft;
+
+	/** Coherent hit is valid */
+	bool bCoherentHitValid;
+
+	/** Coherent hit was found with line trace */
+	bool bCoherentLineTrace;
+
+	/** Primitive the wheel touched on last probe */
+	TWeakObjectPtr<UPrimitiveComponent> LastHitComponent;
+
+	/** Suspension length found by the last visuals only probe (MaxDrop included) */
+	float SampledLength;
+
 	/** Defaults */
 	FSuspensionState()
 	{
@@ -280,6 +559,7 @@ struct FSuspensionState
 		SteeringAngle = 0.f;
 
 		SuspensionForce = FVector::ZeroVector;
+		FrictionForce = FVector::ZeroVector;
 		WheelCollisionLocation = FVector::ZeroVector;
 		WheelCollisionNormal = FVector::UpVector;
 		PreviousWheelCollisionVelocity = FVector::ZeroVector;
@@ -289,6 +569,16 @@ struct FSuspensionState
 
 		SurfaceType = EPhysicalSurface::SurfaceType_Default;
 		DustPSC = nullptr;
+
+		bProbeTicketLineTrace = false;
+
+		CoherentProbeStart = FVector::ZeroVector;
+		CoherentProbeUpVector = FVector::UpVector;
+		CoherentFramesLeft = 0;
+		bCoherentHitValid = false;
+		bCoherentLineTrace = false;
+
+		SampledLength = 0.f;
 	}
 };
 
@@ -374,6 +664,73 @@ struct FTrackInfo
 	}
 };
 
+/** Simulation stages that can run slower than suspension and friction */
+enum class EPrvSimulationStage : uint8
+{
+	Steering,
+	Throttle,
+	GearBox,
+	Brake,
+	Engine,
+	Sound,
+
+	MAX
+};
+
+/** How vehicle is simulated on the tick */
+enum class EPrvTickSimulation : uint8
+{
+	/** Sleeping or simulated remotely */
+	None,
+
+	/** Single step for the frame time */
+	Step,
+
+	/** Fixed steps */
+	FixedSteps,
+};
+
+/** Update rates of slow simulation stages [Hz], zero runs the stage on every simulation step */
+USTRUCT(BlueprintType)
+struct FPrvSimulationStageRates
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Steering input and angular velocity override (angular velocity is corrected only when the stage runs) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0.0", UIMin = "0.0", UIMax = "120.0"))
+	float Steering;
+
+	/** Throttle and torque transfer */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0.0", UIMin = "0.0", UIMax = "120.0"))
+	float Throttle;
+
+	/** Auto gear box */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0.0", UIMin = "0.0", UIMax = "120.0"))
+	float GearBox;
+
+	/** Brake ratio of tracks */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0.0", UIMin = "0.0", UIMax = "120.0"))
+	float Brake;
+
+	/** Engine RPM, drive torque and extra power */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0.0", UIMin = "0.0", UIMax = "120.0"))
+	float Engine;
+
+	/** Engine sound parameters */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0.0", UIMin = "0.0", UIMax = "120.0"))
+	float Sound;
+
+	FPrvSimulationStageRates()
+	{
+		Steering = 0.f;
+		Throttle = 0.f;
+		GearBox = 0.f;
+		Brake = 0.f;
+		Engine = 0.f;
+		Sound = 0.f;
+	}
+};
+
 USTRUCT()
 struct FRepCosmeticData
 {
@@ -405,6 +762,7 @@ struct FRepCosmeticData
 };
 
 struct FAnimNode_PrvWheelHandler;
+class FPrvSubstepForces;
 
 /**
  * Component that uses Torque and Force to move tracked vehicles
@@ -417,12 +775,22 @@ class PSREALVEHICLEPLUGIN_API UPrvVehicleMovementComponent : public UPawnMovemen
 	// Let direct access for animation nodes
 	friend FAnimNode_PrvWheelHandler;
 
+	// Vehicle subsystem runs simulation stages of all vehicles in batched tick
+	friend UPrvVehicleSubsystem;
+
+	// Automation test compares parallel and serial wheel probes
+	friend class FPrvParallelProbesTest;
+
 protected:
 	//////////////////////////////////////////////////////////////////////////
 	// Initialization
 
 	virtual void InitializeComponent() override;
 	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
 	
 	//////////////////////////////////////////////////////////////////////////
 	// Physics initialization
@@ -430,43 +798,205 @@ protected:
 	void InitMesh();
 	void InitBodyPhysics();
 	void InitSuspension();
+
+	/** Copy wheel config into hot simulation arrays */
+	void InitSuspensionSimData();
+
+	/** Copy suspension length, stiffness and damping (global factors applied) into hot simulation arrays */
+	void UpdateSuspensionSimConfig();
+
 	void InitGears();
 	void CalculateMOI();
 
+	/** Build scene query params used by suspension probes */
+	void InitSuspensionQueryParams();
+
+public:
+	/** Bake curves into lookup tables. Should be called after curves are changed at runtime */
+	UFUNCTION(BlueprintCallable, Category = "PsRealVehicle|Components|VehicleMovement")
+	void UpdateCurveTables();
+
+protected:
+
 	//////////////////////////////////////////////////////////////////////////
 	// Physics simulation
 
-	bool IsSleeping(float DeltaTime);
+	/** Read rigid body state for this tick */
+	void CaptureBodySnapshot(FPrvBodySnapshot& OutBody) const;
+
+	/** Input, avoidance and body snapshot part of the tick. Returns false if vehicle can't be simulated */
+	bool BeginTick(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction, FPrvBodySnapshot& OutBody);
+
+	/** Decide how vehicle is simulated on this tick, remote vehicles are updated here */
+	EPrvTickSimulation BeginSimulation(float DeltaTime, const FPrvBodySnapshot& Body);
+
+	/** Apply simulation results and update wheels */
+	void EndTick(float DeltaTime, const FPrvBodySnapshot& Body, EPrvTickSimulation Simulation);
+
+	/** Run all simulation stages for one step. Forces are collected into ForceAccumulator */
+	void SimulateStep(float DeltaTime, const FPrvBodySnapshot& Body);
+
+	/** Control, drivetrain and drive force stages of the step (everything after suspension and friction) */
+	void SimulateDrivetrain(float DeltaTime, const FPrvBodySnapshot& Body);
+
+	/** Run simulation in fixed steps for the frame time and interpolate wheel visuals between the last two of them */
+	void SimulateFixedSteps(float DeltaTime, const FPrvBodySnapshot& Body);
+
+	/** Should simulation run in fixed steps */
+	bool UseFixedStepSimulation() const;
+
+	/** Should suspension, friction and drive forces be added by physics substeps */
+	bool UsePhysicsSubstepForces() const;
+
+	/** Physics substeps have published results for current wheels */
+	bool HasPhysicsSubstepOutput() const;
+
+	/** Pass frame contacts and drivetrain state to physics substeps and schedule them for the next physics frame */
+	void QueuePhysicsSubstepForces(const FPrvBodySnapshot& Body);
+
+	/** Advance the stage clock. Returns true with time elapsed since the last stage update if the stage should run now */
+	bool ShouldUpdateStage(EPrvSimulationStage Stage, float DeltaTime, float& OutStageDeltaTime);
+
+	/** Update rate of the stage [Hz], zero for every step */
+	float GetStageRate(EPrvSimulationStage Stage) const;
+
+	bool IsSleeping(float DeltaTime, const FPrvBodySnapshot& Body);
 	void ResetSleep();
 
 	/** [client/server] */
 	UFUNCTION()
 	void OnRep_IsSleeping();
 
-	void UpdateSteering(float DeltaTime);
-	void UpdateThrottle(float DeltaTime);
-	void UpdateGearBox();
-	void UpdateBrake(float DeltaTime);
+	void UpdateSteering(float DeltaTime, const FPrvBodySnapshot& Body);
+	void UpdateThrottle(float DeltaTime, const FPrvBodySnapshot& Body);
+	void UpdateGearBox(const FPrvBodySnapshot& Body);
+	void UpdateBrake(float DeltaTime, const FPrvBodySnapshot& Body);
 
-	void UpdateTracksVelocity(float DeltaTime);
+	void UpdateTracksVelocity(float DeltaTime, const FPrvBodySnapshot& Body);
 	void UpdateHullVelocity(float DeltaTime);
 
 	/** Calculate value of Start extra power */
-	void UpdateEngineStartExtraPower(float DeltaTime);
+	void UpdateEngineStartExtraPower(float DeltaTime, const FPrvBodySnapshot& Body);
 
-	void UpdateEngine();
-	void UpdateDriveForce();
+	void UpdateEngine(const FPrvBodySnapshot& Body);
+	void UpdateDriveForce(const FPrvBodySnapshot& Body);
 	void UpdateSound(float DeltaTime);
 
 	/** Tick of anti-rollover system */
-	void UpdateAntiRollover(float DeltaTime);
+	void UpdateAntiRollover(float DeltaTime, const FPrvBodySnapshot& Body);
+
+	/** Find ground contacts of all wheels for this tick. Makes only read-only scene queries */
+	void ProbeWheels(const FPrvBodySnapshot& Body);
+
+	/** Find ground contacts of given wheels into given buffers, live wheels state is left as is */
+	void ProbeWheels(const FPrvBodySnapshot& Body, TArray<FSuspensionState>& Wheels, FPrvSuspensionSimData& Sim, TArray<FHitResult>& Hits, TArray<bool>& HitsBlocking);
+
+	/** Probes can be made on worker thread (no shared probe queue, baked ground or debug drawing) */
+	bool CanProbeWheelsInParallel() const;
+
+	/** Repeat probes of this tick from given wheels state on copies and compare contacts with current ones. Returns number of mismatched wheels */
+	int32 ValidateProbeWheels(const FPrvBodySnapshot& Body, const TArray<FSuspensionState>& WheelsBeforeProbes);
+
+	/** Suspension forces from the contacts of ProbeWheels() */
+	void UpdateSuspension(float DeltaTime, const FPrvBodySnapshot& Body);
+
+	/** Spring-damper force of all wheels with ground contact */
+	void UpdateSuspensionForces(float DeltaTime, float VehicleMass, float GravityZ, int32 ActiveWheelsNum);
 
-	void UpdateSuspension(float DeltaTime);
+	/** Rebuild damping correction tables if wheels stiffness or damping, vehicle mass or correction settings have changed */
+	void UpdateDampingCorrectionTables(float VehicleMass);
+
+	/** Should damping correction be taken from precomputed tables */
+	bool UseDampingCorrectionTables() const;
 
 	/** Trace just to put wheels on the ground, don't calculate physics (used for proxy actors) */
-	void UpdateSuspensionVisualsOnly(float DeltaTime);
+	void UpdateSuspensionVisualsOnly(float DeltaTime, const FPrvBodySnapshot& Body);
+
+	/** Move wheels that weren't probed this frame using their last samples and probed neighbors on the same track */
+	void InterpolateSkippedWheels(float DeltaTime, int32 ProbeDivisor, int32 ProbePhase);
+
+	/** Number of frames to probe all wheels of proxy vehicle */
+	int32 GetVisualsOnlyProbeDivisor() const;
+
+	//////////////////////////////////////////////////////////////////////////
+	// Suspension probes
+
+	/** Build world space probe geometry for the wheel */
+	void MakeWheelProbe(const FSuspensionState& SuspState, const FTransform& MeshTransform, bool bUseLineTrace, FPrvWheelProbe& OutProbe) const;
+
+	/** Convert wheel probe into scene query request */
+	void MakeProbeRequest(const FPrvWheelProbe& Probe, FPrvProbeRequest& OutRequest) const;
 
-	void UpdateFriction(float DeltaTime);
+	/** Find wheel contact. Uses async results of the previous frame when possible */
+	bool TraceWheel(FSuspensionState& SuspState, const FPrvWheelProbe& Probe, FHitResult& OutHit, bool& bOutHitValid);
+
+	/** Move box sweep hit to where the wheel cylinder touches the same ground plane. Returns false if cylinder doesn't reach the ground */
+	bool CorrectBoxSweepHit(const FPrvWheelProbe& Probe, FHitResult& InOutHit) const;
+
+	/** Select the contact from raw probe hits */
+	bool ResolveWheelHits(const FSuspensionState& SuspState, const FPrvWheelProbe& Probe, TArrayView<const FHitResult> Hits, FHitResult& OutHit, bool& bOutHitValid) const;
+
+	/** Should suspension probes go through the subsystem async batch */
+	bool UseAsyncTrace() const;
+
+	/** Try to reuse the last wheel contact if the wheel hasn't moved. Returns true if contact was reused */
+	bool ReuseCoherentHit(FSuspensionState& SuspState, const FPrvWheelProbe& Probe, FHitResult& OutHit, bool& bOutHitValid) const;
+
+	/** Store the wheel contact for reuse on next ticks */
+	void CacheCoherentHit(FSuspensionState& SuspState, const FPrvWheelProbe& Probe, const FHitResult& Hit, bool bHitValid) const;
+
+	/** Run synchronous scene query for the wheel probe */
+	bool TraceWheelSync(const FSuspensionState& SuspState, const FPrvWheelProbe& Probe, FHitResult& OutHit, bool& bOutHitValid);
+
+	/** Collect primitives around all wheels with one overlap query. Returns false if broadphase shouldn't be used */
+	bool UpdateSuspensionBroadphase(const FPrvBodySnapshot& Body, bool bUseLineTrace);
+
+	/** Probe the wheel against given primitives only */
+	bool TraceWheelNarrowphase(const FSuspensionState& SuspState, const FPrvWheelProbe& Probe, TArrayView<UPrimitiveComponent* const> Components, FHitResult& OutHit, bool& bOutHitValid);
+
+	/** Probe the wheel against landscape heightfields found by broadphase. Returns false if world query is required */
+	bool TraceWheelLandscape(const FSuspensionState& SuspState, const FPrvWheelProbe& Probe, FHitResult& OutHit, bool& bOutHitValid);
+
+	/** Should landscape heightfield be sampled directly */
+	bool UseLandscapeGround() const;
+
+	/** Sample ground profile under each track. Returns false if wheels should be probed separately */
+	bool UpdateTrackProfiles(const FTransform& MeshTransform);
+
+	/** Take wheel contact from its track ground profile. Returns false if wheel should be probed separately */
+	bool TraceWheelTrackProfile(const FSuspensionState& SuspState, const FPrvWheelProbe& Probe, FHitResult& OutHit, bool& bOutHitValid) const;
+
+	/** Should tracks ground profile be used instead of per wheel probes */
+	bool UseTrackProfile() const;
+
+	/** Probe the wheel against baked static ground grid. Returns false if world query is required */
+	bool TraceWheelBakedGround(const FSuspensionState& SuspState, const FPrvWheelProbe& Probe, FHitResult& OutHit, bool& bOutHitValid);
+
+	/** Should baked ground grid be used */
+	bool UseBakedGround() const;
+
+	/** Surface type of the wheel contact: from physical material or from baked ground cell if it has no material */
+	static EPhysicalSurface GetWheelSurfaceType(const FHitResult& Hit);
+
+	/** Probe the wheel against the primitive it touched last time. Returns false if world query is required */
+	bool TraceWheelLastContact(const FSuspensionState& SuspState, const FPrvWheelProbe& Probe, FHitResult& OutHit, bool& bOutHitValid);
+
+	void UpdateFriction(float DeltaTime, const FPrvBodySnapshot& Body);
+
+	/** Take wheel loads, friction forces and track speeds from physics substeps results */
+	void UpdateFrictionFromSubsteps();
+
+	/** Apply forces accumulated during the tick to the body */
+	void FlushForceAccumulator();
+
+	/** Add suspension reaction force to the environment primitive */
+	void AddReactionForce(UPrimitiveComponent* Component, const FVector& Force, const FVector& Location);
+
+	/** Apply reaction forces collected on this step, once per primitive */
+	void FlushReactionForces(UPrvVehicleSubsystem* PhysicsCommandQueue);
+
+	/** Subsystem that should apply physics commands of this vehicle. Returns nullptr if forces should be applied immediately */
+	UPrvVehicleSubsystem* GetPhysicsCommandQueue() const;
 	void UpdateLinearVelocity(float DeltaTime);
 	void UpdateAngularVelocity(float DeltaTime);
 
@@ -481,6 +1011,12 @@ protected:
 	/*Same but for timers*/
 	void ShiftGearByTimer();
 
+	/** Start delayed gear shift timer and notify about the shift (game thread only) */
+	void StartGearShiftTimer(int32 FromGear);
+
+	/** Run game thread work deferred while simulation stages were running in parallel */
+	void FlushDeferredEvents();
+
 	//////////////////////////////////////////////////////////////////////////
 	// Network
 
@@ -573,6 +1109,7 @@ protected:
 	UFUNCTION(BlueprintCallable, Category = "Pawn|Components|WheeledVehicleMovement")
 	void SetAvoidanceGroupMask(const FNavAvoidanceMask& GroupMask);
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	/** Will avoid other agents if they are in one of specified groups */
 	UPROPERTY(Category = "Avoidance", EditAnywhere, BlueprintReadOnly, AdvancedDisplay)
 	FNavAvoidanceMask GroupsToAvoid;
@@ -716,6 +1253,30 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Vehicle)
 	float SleepDelay;
 
+	/** Queue forces into vehicle subsystem to be applied together with all other vehicles under one physics scene lock */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Vehicle)
+	bool bDeferredPhysicsCommands;
+
+	/** Run simulation in fixed steps independent of frame rate, wheel visuals are interpolated between steps */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Vehicle)
+	bool bFixedStepSimulation;
+
+	/** Fixed simulation steps per second */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Vehicle, meta = (EditCondition = "bFixedStepSimulation", ClampMin = "10.0", UIMin = "10.0", UIMax = "240.0"))
+	float FixedStepRate;
+
+	/** Max fixed steps per frame, frame time above that is dropped to keep the cost bounded */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Vehicle, meta = (EditCondition = "bFixedStepSimulation", ClampMin = "1", UIMin = "1", UIMax = "8"))
+	int32 MaxFixedSteps;
+
+	/** Evaluate suspension, friction and drive forces on each physics substep with the substep body pose against ground contacts of the frame probe. Needs physics substepping enabled in project settings, vehicle falls back to frame forces otherwise. Not used with fixed step simulation */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Vehicle)
+	bool bPhysicsSubstepForces;
+
+	/** Update rates of drivetrain and control stages, their outputs are held between updates. Suspension, friction and tracks velocity run on every step */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Vehicle)
+	FPrvSimulationStageRates StageRates;
+
 	/** Whether gravity is disabled for ROLE_SimulatedProxy */
 	bool bDisableGravityForSimulated;
 
@@ -737,6 +1298,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Vehicle, meta = (editcondition = "bEnableAntiRollover"))
 	FRuntimeFloatCurve AntiRolloverForceCurve;
 
+	/** Number of lookup table steps AntiRolloverForceCurve is baked into */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, AdvancedDisplay, Category = Vehicle, meta = (ClampMin = "1", UIMin = "1"))
+	int32 AntiRolloverForceCurveResolution;
+
 	/** Value of sine alpha in the last tick */
 	UPROPERTY(Transient)
 	float LastAntiRolloverValue;
@@ -814,10 +1379,18 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Suspension)
 	bool bAdaptiveDampingCorrection;
 
+	/** Integrate spring-damper implicitly over the tick: stays stable with stiff suspension at low tick rates (20-30 Hz), damping corrections are not used then */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Suspension)
+	bool bImplicitSuspension;
+
 	/** How fast wheels are animated while going down */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Suspension)
 	float DropFactor;
 
+	/** Simulated proxies probe only every Nth wheel per frame, other wheels are interpolated (1 = probe all wheels) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Suspension, meta = (ClampMin = "1", UIMin = "1", UIMax = "4"))
+	int32 VisualsOnlyProbeDivisor;
+
 	/**	Should 'Hit' events fire when this object collides during physics simulation */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Suspension, meta = (DisplayName = "Simulation Generates Hit Events"))
 	bool bNotifyRigidBodyCollision;
@@ -830,6 +1403,42 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Suspension)
 	TEnumAsByte<ETraceTypeQuery> SuspensionTraceTypeQuery;
 
+	/** Run suspension probes through vehicle subsystem async batch (results are one frame late) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Suspension)
+	bool bAsyncSuspensionTrace;
+
+	/** Collect ground primitives with one overlap per vehicle and probe wheels against them only */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Suspension)
+	bool bSuspensionBroadphase;
+
+	/** Sample landscape heightfield directly when nothing but landscape is under the vehicle (enables broadphase) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Suspension)
+	bool bLandscapeGround;
+
+	/** Use ground grid baked by PrvBakeGroundGrid commandlet when only static geometry is under the vehicle (enables broadphase) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Suspension)
+	bool bBakedGround;
+
+	/** Tracked vehicles sample one ground profile per track and put road wheels on it instead of probing each wheel */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Suspension, meta = (editcondition = "!bWheeledVehicle"))
+	bool bTrackGroundProfile;
+
+	/** Number of line probes along each track for ground profile */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Suspension, meta = (editcondition = "bTrackGroundProfile", ClampMin = "2", UIMin = "2", UIMax = "8"))
+	int32 TrackProfileSamples;
+
+	/** Reuse last wheel contact while the wheel stays in place on static geometry */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Suspension)
+	bool bSuspensionCoherence;
+
+	/** Max distance the wheel probe can move to reuse the last contact [cm] */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Suspension, meta = (EditCondition = "bSuspensionCoherence", ClampMin = "0.0", UIMin = "0.0"))
+	float SuspensionCoherenceDistance;
+
+	/** Reused contact is revalidated with a real trace after this number of frames */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Suspension, meta = (EditCondition = "bSuspensionCoherence", ClampMin = "1", UIMin = "1"))
+	int32 SuspensionCoherenceFrames;
+
 	/** Clamp SuspensionForce above zero */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Suspension)
 	bool bClampSuspensionForce;
@@ -870,6 +1479,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EngineSetup)
 	FRuntimeFloatCurve EngineTorqueCurve;
 
+	/** Number of lookup table steps EngineTorqueCurve is baked into (sharp torque drop at max RPM needs a dense table) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, AdvancedDisplay, Category = EngineSetup, meta = (ClampMin = "1", UIMin = "1"))
+	int32 EngineTorqueCurveResolution;
+
 
 	/**  */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EngineSetup)
@@ -912,6 +1525,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EngineSetup, meta = (editcondition = "bLimitMaxSpeed"))
 	FRuntimeFloatCurve MaxSpeedCurve;
 
+	/** Number of lookup table steps MaxSpeedCurve is baked into */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, AdvancedDisplay, Category = EngineSetup, meta = (ClampMin = "1", UIMin = "1"))
+	int32 MaxSpeedCurveResolution;
+
 	/** */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = EngineSetup)
 	bool bScaleForceToActiveFrictionPoints;
@@ -960,6 +1577,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = SteeringSetup, meta = (editcondition = "bUseSteeringCurve"))
 	FRuntimeFloatCurve SteeringCurve;
 
+	/** Number of lookup table steps SteeringCurve is baked into */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, AdvancedDisplay, Category = SteeringSetup, meta = (ClampMin = "1", UIMin = "1"))
+	int32 SteeringCurveResolution;
+
 	/** Whether we use SteeringCurve(0) steering without throttle input */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = SteeringSetup, meta = (editcondition = "bUseSteeringCurve"))
 	bool bMaximizeZeroThrottleSteering;
@@ -993,6 +1614,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = BrakeSystem, meta = (editcondition = "bAutoBrake"))
 	FRuntimeFloatCurve AutoBrakeUpRatio;
 
+	/** Number of lookup table steps AutoBrakeUpRatio is baked into */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, AdvancedDisplay, Category = BrakeSystem, meta = (ClampMin = "1", UIMin = "1"))
+	int32 AutoBrakeUpRatioResolution;
+
 	/** How much brake applied by auto-brake system */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = BrakeSystem, meta = (editcondition = "bAutoBrake"))
 	float AutoBrakeFactor;
@@ -1047,6 +1672,64 @@ protected:
 	float FinalMOI;
 
 	TArray<FSuspensionState> SuspensionData;
+
+	/** Hot suspension simulation data of SuspensionData wheels */
+	FPrvSuspensionSimData SuspensionSimData;
+
+	/** Wheel contacts found on this tick (scratch) */
+	TArray<FHitResult> SuspensionHits;
+
+	/** Wheel probes that had blocking hit on this tick */
+	TArray<bool> SuspensionHitsBlocking;
+
+	/** Custom damping correction of each distinct wheel (stiffness, damping) pair */
+	TArray<FPrvDampingCorrectionTable> DampingCorrectionTables;
+
+	/** Vehicle mass the damping correction tables were built for */
+	float DampingCorrectionTablesMass;
+
+	/** Correction factor the damping correction tables were built for */
+	float DampingCorrectionTablesFactor;
+
+	/** Frame time not simulated by fixed steps yet */
+	float FixedStepAccumulator;
+
+	/** Scale of suspension reaction forces (averages them over fixed steps of the frame) */
+	float ReactionForceScale;
+
+	/** Average force and torque of the last fixed steps, applied on frames without steps */
+	FVector FixedStepForce;
+	FVector FixedStepTorque;
+
+	/** Steering angular velocity override of the last fixed step, applied on frames without steps */
+	FVector FixedStepAngularVelocityInDegrees;
+	bool bFixedStepSetAngularVelocity;
+
+	/** Wheel visuals of the last two fixed steps */
+	TArray<FPrvFixedStepWheelVisuals> FixedStepWheelVisuals;
+
+	/** Vehicle forces solver of physics substeps */
+	TSharedPtr<FPrvSubstepForces, ESPMode::ThreadSafe> SubstepForces;
+
+	/** Physics substep callback bound to SubstepForces */
+	FCalculateCustomPhysics OnCalculateCustomPhysics;
+
+	/** Physics substeps were scheduled on the last tick */
+	bool bSubstepForcesQueued;
+
+	/** Vehicle is ticked by vehicle subsystem together with other vehicles */
+	bool bBatchedTick;
+
+	/** Time passed since the last update of each slow stage */
+	float StageElapsedTime[(int32)EPrvSimulationStage::MAX];
+
+	/** Baked curves (nullptr if curve can't be baked) */
+	TSharedPtr<const FPrvCurveTable> EngineTorqueCurveTable;
+	TSharedPtr<const FPrvCurveTable> MaxSpeedCurveTable;
+	TSharedPtr<const FPrvCurveTable> SteeringCurveTable;
+	TSharedPtr<const FPrvCurveTable> AutoBrakeUpRatioTable;
+	TSharedPtr<const FPrvCurveTable> AntiRolloverForceCurveTable;
+
 	int32 LastGear;
 	int32 NeutralGear;
 	int32 CurrentGear;
@@ -1057,6 +1740,13 @@ protected:
 	bool bZeroTorqueWhenShifting;
 	bool bGearTimer;
 	bool bPendingShiftUp;
+
+	/** Game thread work (timers, events) should be deferred, simulation stages run on worker thread */
+	bool bDeferGameThreadEvents;
+
+	/** Delayed gear shift was made while events were deferred */
+	bool bGearShiftTimerPending;
+	int32 PendingGearShiftFromGear;
 	UPROPERTY(BlueprintReadOnly)
 	bool bHasEngineLoad;
 	bool bReverseGear;
@@ -1209,6 +1899,9 @@ protected:
 	/** State used for non-authority actors */
 	bool bShouldAnimateWheels;
 
+	/** Rotates wheels probed by UpdateSuspensionVisualsOnly */
+	int32 VisualsOnlyProbePhase;
+
 	//////////////////////////////////////////////////////////////////////////
 	// Vehicle stats
 
@@ -1410,11 +2103,44 @@ public:
 
 protected:
 	/** Don't apply forces for simulated proxy locally */
-	bool ShouldAddForce();
+	bool ShouldAddForce() const;
 
 	/** Use line trace */
 	bool UseLineTrace();
 
+	/** Collision channel of SuspensionTraceTypeQuery */
+	ECollisionChannel SuspensionTraceChannel;
+
+	/** Trace type the cached query params were built for */
+	TEnumAsByte<ETraceTypeQuery> CachedSuspensionTraceTypeQuery;
+
+	/** Cached suspension query params (owner is ignored) */
+	FCollisionQueryParams SuspensionQueryParams;
+
+	/** Cached suspension response params */
+	FCollisionResponseParams SuspensionResponseParams;
+
+	/** Primitives found by suspension broadphase on this tick */
+	TArray<UPrimitiveComponent*> BroadphaseComponents;
+
+	/** Wheel probes should use broadphase primitives */
+	bool bBroadphaseActive;
+
+	/** Broadphase found landscape heightfields only */
+	bool bBroadphaseLandscapeOnly;
+
+	/** Ground profiles of left [0] and right [1] tracks */
+	FPrvTrackProfile TrackProfiles[2];
+
+	/** Baked ground grid that can answer probes on this tick (only static geometry found by broadphase) */
+	FPrvGroundGrid* BroadphaseGroundGrid;
+
+	/** Forces collected on this tick */
+	FPrvForceAccumulator ForceAccumulator;
+
+	/** Suspension reaction forces collected on this step, one per environment primitive */
+	TArray<FPrvReactionForce> ReactionForces;
+
 	/** Get camera vector (for client only) */
 	bool GetCameraVector(FVector& RelativeCameraVector, FVector& RelativeMeshForwardVector);
 
@@ -1501,3 +2227,9 @@ inline float PrvOmegaToRPM(float Omega)
 {
 	return Omega * 30.f / PI;
 }
+
+// Engine RPM driven by vehicle speed through transmission (gear and differential ratio), within engine limits
+inline float PrvSpeedToEngineRPM(float TransmissionRatio, float Speed, float MinEngineRPM, float MaxEngineRPM)
+{
+	return FMath::Clamp(PrvOmegaToRPM(TransmissionRatio * Speed / 20), MinEngineRPM, MaxEngineRPM);
+}
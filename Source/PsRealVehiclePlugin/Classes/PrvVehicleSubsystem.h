@@ -0,0 +1,312 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#pragma once
+
+#include "CollisionQueryParams.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/EngineTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+
+#include "PrvGroundGrid.h"
+
+#include "PrvVehicleSubsystem.generated.h"
+
+class UPhysicalMaterial;
+class UPrimitiveComponent;
+class UPrvVehicleMovementComponent;
+class UPrvVehicleSubsystem;
+
+/** Handle of the wheel probe queued into vehicle subsystem */
+struct FPrvProbeTicket
+{
+	/** Frame the probe was requested on */
+	uint64 FrameNumber;
+
+	/** Index in the frame batch */
+	int32 Index;
+
+	FPrvProbeTicket()
+		: FrameNumber(0)
+		, Index(INDEX_NONE)
+	{
+	}
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+	void Invalidate() { Index = INDEX_NONE; }
+};
+
+/** Single suspension scene query waiting for the batch submission */
+struct FPrvProbeRequest
+{
+	FVector Start;
+	FVector End;
+	FQuat Rotation;
+
+	/** Line shape means line trace */
+	FCollisionShape Shape;
+
+	ECollisionChannel Channel;
+	EAsyncTraceType TraceType;
+
+	FCollisionQueryParams QueryParams;
+	FCollisionResponseParams ResponseParams;
+
+	FPrvProbeRequest()
+		: Start(FVector::ZeroVector)
+		, End(FVector::ZeroVector)
+		, Rotation(FQuat::Identity)
+		, Channel(ECC_Visibility)
+		, TraceType(EAsyncTraceType::Single)
+	{
+	}
+};
+
+/** Kind of deferred write to rigid body */
+enum class EPrvPhysicsCommandType : uint8
+{
+	Force,
+	Torque,
+	AngularVelocity,
+};
+
+/** Rigid body write queued by vehicle to be applied in the subsystem batch */
+struct FPrvPhysicsCommand
+{
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+
+	/** Force, torque (radians) or angular velocity (degrees) depending on type */
+	FVector Value;
+
+	EPrvPhysicsCommandType Type;
+
+	FPrvPhysicsCommand()
+		: Value(FVector::ZeroVector)
+		, Type(EPrvPhysicsCommandType::Force)
+	{
+	}
+
+	FPrvPhysicsCommand(UPrimitiveComponent* InComponent, EPrvPhysicsCommandType InType, const FVector& InValue)
+		: Component(InComponent)
+		, Value(InValue)
+		, Type(InType)
+	{
+	}
+};
+
+/** Suspension reaction forces pushed onto one environment primitive by all wheels on the frame */
+struct FPrvReactionForce
+{
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+
+	/** Net force */
+	FVector Force;
+
+	/** Net torque about the reference point (radians) */
+	FVector Torque;
+
+	/** Location of the first contact (keeps torque arms short) */
+	FVector ReferencePoint;
+
+	FPrvReactionForce()
+		: Force(FVector::ZeroVector)
+		, Torque(FVector::ZeroVector)
+		, ReferencePoint(FVector::ZeroVector)
+	{
+	}
+
+	FPrvReactionForce(UPrimitiveComponent* InComponent, const FVector& InReferencePoint)
+		: Component(InComponent)
+		, Force(FVector::ZeroVector)
+		, Torque(FVector::ZeroVector)
+		, ReferencePoint(InReferencePoint)
+	{
+	}
+
+	void AddForceAtLocation(const FVector& InForce, const FVector& Location)
+	{
+		Force += InForce;
+		Torque += FVector::CrossProduct(Location - ReferencePoint, InForce);
+	}
+
+	/** Add net force and torque of the other reaction on the same primitive */
+	void Add(const FPrvReactionForce& Other)
+	{
+		Force += Other.Force;
+		Torque += Other.Torque + FVector::CrossProduct(Other.ReferencePoint - ReferencePoint, Other.Force);
+	}
+};
+
+/** Runs vehicle subsystem after all registered vehicles were ticked */
+USTRUCT()
+struct FPrvVehicleSubsystemTickFunction : public FTickFunction
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPrvVehicleSubsystem* Target;
+
+	FPrvVehicleSubsystemTickFunction()
+		: Target(nullptr)
+	{
+	}
+
+	// FTickFunction interface
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+	// End of FTickFunction interface
+};
+
+template <>
+struct TStructOpsTypeTraits<FPrvVehicleSubsystemTickFunction> : public TStructOpsTypeTraitsBase2<FPrvVehicleSubsystemTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/** Ticks all registered vehicles in one loop when batched tick is enabled */
+USTRUCT()
+struct FPrvVehicleBatchTickFunction : public FTickFunction
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPrvVehicleSubsystem* Target;
+
+	FPrvVehicleBatchTickFunction()
+		: Target(nullptr)
+	{
+	}
+
+	// FTickFunction interface
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+	// End of FTickFunction interface
+};
+
+template <>
+struct TStructOpsTypeTraits<FPrvVehicleBatchTickFunction> : public TStructOpsTypeTraitsBase2<FPrvVehicleBatchTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * World-level service shared by all vehicles.
+ * Collects suspension probes of every vehicle for the frame and submits them as one async batch,
+ * so physics scene can run them in parallel. Results are available on the next frame.
+ * Forces and velocities of all vehicles are applied in one batch too, before physics simulation starts.
+ * Can tick all vehicles in one loop too, running each simulation stage for every vehicle before the next one.
+ */
+UCLASS()
+class PSREALVEHICLEPLUGIN_API UPrvVehicleSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UPrvVehicleSubsystem();
+
+	// USubsystem interface
+	virtual void Deinitialize() override;
+	// End of USubsystem interface
+
+	//////////////////////////////////////////////////////////////////////////
+	// Vehicles registry
+
+	/** Vehicle should be registered to be ticked before the subsystem */
+	void RegisterVehicle(UPrvVehicleMovementComponent* Vehicle);
+
+	/** Remove vehicle from the subsystem */
+	void UnregisterVehicle(UPrvVehicleMovementComponent* Vehicle);
+
+	/** Called by tick function after all vehicles were ticked */
+	void Tick(float DeltaTime);
+
+	/** Called by batch tick function: simulate all vehicles stage by stage if batched tick is enabled */
+	void TickVehicles(float DeltaTime, ELevelTick TickType);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Suspension probes
+
+	/** Queue probe for the batch submission on this frame */
+	FPrvProbeTicket RequestProbe(const FPrvProbeRequest& Request);
+
+	/** Get results of the probe queued on the previous frame. Returns false if results are not available */
+	bool GetProbeResult(const FPrvProbeTicket& Ticket, TArray<FHitResult>& OutHits);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Physics commands
+
+	/** Queue rigid body write to be applied with the whole frame batch */
+	void QueuePhysicsCommand(const FPrvPhysicsCommand& Command);
+
+	/** Add suspension reaction forces of one vehicle to the environment primitive. All forces on the same primitive are applied as one */
+	void QueueReactionForce(const FPrvReactionForce& Reaction);
+
+	//////////////////////////////////////////////////////////////////////////
+	// Baked ground
+
+	/** Static ground grid baked for the map (mapped on first request). Returns nullptr if there is no grid */
+	FPrvGroundGrid* GetGroundGrid();
+
+protected:
+	/** Switch vehicles between their own tick functions and batched tick */
+	void SetBatchedTick(bool bEnable);
+
+	/** Submit all pending probes as async scene queries */
+	void FlushProbes();
+
+	/** Apply all queued physics commands under one scene write lock */
+	void FlushPhysicsCommands();
+
+	/** Drop physics commands queued on previous frames */
+	void ResetStalePhysicsCommands();
+
+	/** Probes requested on current frame */
+	TArray<FPrvProbeRequest> PendingProbes;
+
+	/** Frame the pending probes were requested on */
+	uint64 PendingFrameNumber;
+
+	/** Async trace handles of the last submitted batch */
+	TArray<FTraceHandle> SubmittedProbes;
+
+	/** Frame the submitted probes were requested on */
+	uint64 SubmittedFrameNumber;
+
+	/** Physics commands queued on current frame */
+	TArray<FPrvPhysicsCommand> PendingPhysicsCommands;
+
+	/** Reaction forces queued on current frame */
+	TArray<FPrvReactionForce> PendingReactionForces;
+
+	/** Index of the primitive in PendingReactionForces */
+	TMap<UPrimitiveComponent*, int32> ReactionForceIndices;
+
+	/** Frame the physics commands were queued on */
+	uint64 PhysicsCommandsFrameNumber;
+
+	/** Baked static ground of the map */
+	FPrvGroundGrid GroundGrid;
+
+	/** Ground grid file was already looked for */
+	bool bGroundGridRequested;
+
+	/** Physical materials used by ground grid */
+	UPROPERTY(Transient)
+	TArray<UPhysicalMaterial*> GroundGridMaterials;
+
+	/** All registered vehicles */
+	TArray<TWeakObjectPtr<UPrvVehicleMovementComponent>> Vehicles;
+
+	/** Subsystem tick */
+	FPrvVehicleSubsystemTickFunction TickFunction;
+
+	/** Tick of all vehicles, runs before subsystem tick */
+	FPrvVehicleBatchTickFunction BatchTickFunction;
+
+	/** Vehicles are ticked by BatchTickFunction instead of their own tick functions */
+	bool bBatchedTick;
+};
@@ -0,0 +1,101 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#include "PrvCurveTable.h"
+
+/** Number of error checks per table step */
+static constexpr int32 PrvCurveTableErrorSamples = 4;
+
+static uint32 PrvHashCurveKeys(const TArray<FRichCurveKey>& Keys, int32 Resolution)
+{
+	uint32 Hash = GetTypeHash(Resolution);
+	for (const FRichCurveKey& Key : Keys)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(Key.Time));
+		Hash = HashCombine(Hash, GetTypeHash(Key.Value));
+		Hash = HashCombine(Hash, GetTypeHash(Key.ArriveTangent));
+		Hash = HashCombine(Hash, GetTypeHash(Key.LeaveTangent));
+		Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(Key.InterpMode)));
+	}
+
+	return Hash;
+}
+
+static TSharedPtr<const FPrvCurveTable> PrvBakeCurveTable(const FRichCurve& Curve, int32 Resolution)
+{
+	TSharedPtr<FPrvCurveTable> Table = MakeShared<FPrvCurveTable>();
+	Table->SourceKeys = Curve.GetConstRefOfKeys();
+	Table->Resolution = Resolution;
+
+	float MinTime = 0.f;
+	float MaxTime = 0.f;
+	Curve.GetTimeRange(MinTime, MaxTime);
+
+	// Constant curve still gets two samples, so lookup never branches
+	const int32 StepsNum = (MaxTime - MinTime > KINDA_SMALL_NUMBER) ? Resolution : 1;
+	const float Step = (StepsNum > 1) ? (MaxTime - MinTime) / StepsNum : 0.f;
+
+	Table->MinTime = MinTime;
+	Table->InvStep = (Step > 0.f) ? (1.f / Step) : 0.f;
+
+	Table->Values.SetNumUninitialized(StepsNum + 1);
+	for (int32 Index = 0; Index <= StepsNum; ++Index)
+	{
+		Table->Values[Index] = Curve.Eval(MinTime + Step * Index);
+	}
+
+	// Measure error between samples
+	float MinValue = Table->Values[0];
+	float MaxValue = Table->Values[0];
+	for (int32 Index = 0; Index < StepsNum * PrvCurveTableErrorSamples; ++Index)
+	{
+		const float Time = MinTime + Step * Index / PrvCurveTableErrorSamples;
+		const float SourceValue = Curve.Eval(Time);
+		MinValue = FMath::Min(MinValue, SourceValue);
+		MaxValue = FMath::Max(MaxValue, SourceValue);
+		Table->MaxError = FMath::Max(Table->MaxError, FMath::Abs(Table->Eval(Time) - SourceValue));
+	}
+
+	Table->ValueRange = MaxValue - MinValue;
+
+	return Table;
+}
+
+TSharedPtr<const FPrvCurveTable> FPrvCurveTable::FindOrBake(const FRichCurve& Curve, int32 Resolution)
+{
+	check(IsInGameThread());
+
+	if (Curve.PreInfinityExtrap != RCCE_Constant || Curve.PostInfinityExtrap != RCCE_Constant)
+	{
+		return nullptr;
+	}
+
+	Resolution = FMath::Max(1, Resolution);
+
+	// Empty curve value depends on curve default value, so it's not shared
+	const TArray<FRichCurveKey>& Keys = Curve.GetConstRefOfKeys();
+	if (Keys.Num() == 0)
+	{
+		return PrvBakeCurveTable(Curve, Resolution);
+	}
+
+	static TMap<uint32, TArray<TWeakPtr<const FPrvCurveTable>>> SharedTables;
+
+	TArray<TWeakPtr<const FPrvCurveTable>>& Bucket = SharedTables.FindOrAdd(PrvHashCurveKeys(Keys, Resolution));
+	for (int32 Index = Bucket.Num() - 1; Index >= 0; --Index)
+	{
+		TSharedPtr<const FPrvCurveTable> SharedTable = Bucket[Index].Pin();
+		if (SharedTable.IsValid() == false)
+		{
+			// All vehicles with this curve are gone
+			Bucket.RemoveAtSwap(Index);
+		}
+		else if (SharedTable->Resolution == Resolution && SharedTable->SourceKeys == Keys)
+		{
+			return SharedTable;
+		}
+	}
+
+	TSharedPtr<const FPrvCurveTable> Table = PrvBakeCurveTable(Curve, Resolution);
+	Bucket.Add(Table);
+	return Table;
+}
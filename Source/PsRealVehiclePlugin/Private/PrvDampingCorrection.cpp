@@ -0,0 +1,104 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#include "PrvDampingCorrection.h"
+
+/** Argument range of adaptive correction table, closed form is used above */
+static constexpr float PrvAdaptiveTableMaxX = 16.f;
+static constexpr int32 PrvAdaptiveTableResolution = 1024;
+
+/** g(x) = (1 - exp(-x)) / x, damping is kept as is when correction is negligible */
+static float PrvAdaptiveScale(float X)
+{
+	const float AdaptiveExp = 1.f - FMath::Exp(-X);
+	if (FMath::Abs(AdaptiveExp) <= SMALL_NUMBER)
+	{
+		return 1.f;
+	}
+
+	return AdaptiveExp / X;
+}
+
+/** Shared table of g(x) over [0; PrvAdaptiveTableMaxX] */
+static const TArray<float>& PrvGetAdaptiveTable()
+{
+	static TArray<float> AdaptiveTable = []()
+	{
+		TArray<float> Table;
+		Table.SetNumUninitialized(PrvAdaptiveTableResolution + 1);
+		for (int32 Index = 0; Index <= PrvAdaptiveTableResolution; ++Index)
+		{
+			Table[Index] = PrvAdaptiveScale(PrvAdaptiveTableMaxX * Index / PrvAdaptiveTableResolution);
+		}
+		return Table;
+	}();
+
+	return AdaptiveTable;
+}
+
+static float PrvSampleTable(const TArray<float>& Table, float Position)
+{
+	const int32 Index = FMath::Clamp(FMath::FloorToInt(Position), 0, Table.Num() - 2);
+	return FMath::Lerp(Table[Index], Table[Index + 1], Position - Index);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FPrvDampingCorrection
+
+float FPrvDampingCorrection::CalcVelocityScale(float Stiffness, float Damping, float Mass, float DeltaTime, float CorrectionFactor)
+{
+	// Same math as per wheel correction with unit velocity (it cancels out)
+	const float suspVel = 1.f / 100.f;
+	const float k = Stiffness / 100.f;
+	const float m = Mass;
+	const float b = Damping / (2.f * m);
+	const float a_lin = FMath::Square(b) - (k / m);
+	const float a = FMath::Sqrt(FMath::Max(1.f, a_lin));
+	const float A = suspVel / (2.f * a);
+	const float B = -A;
+	const float dL_old = suspVel * DeltaTime;
+	const float dL_new = FMath::Exp(-b * DeltaTime) * (A * FMath::Exp(a * DeltaTime) + B * FMath::Exp(-a * DeltaTime));
+	const float Kl = dL_new / dL_old;
+
+	return suspVel * FMath::Pow(Kl, CorrectionFactor);
+}
+
+float FPrvDampingCorrection::CalcAdaptiveDampingScale(float Damping, float Mass, int32 ActiveWheelsNum, float DeltaTime)
+{
+	const float D = Damping / 100.f;
+	return PrvAdaptiveScale(D * ActiveWheelsNum / Mass * DeltaTime);
+}
+
+float FPrvDampingCorrection::GetAdaptiveDampingScale(float Damping, float Mass, int32 ActiveWheelsNum, float DeltaTime)
+{
+	const float X = (Damping / 100.f) * ActiveWheelsNum / Mass * DeltaTime;
+	if (X < 0.f || X >= PrvAdaptiveTableMaxX)
+	{
+		return PrvAdaptiveScale(X);
+	}
+
+	return PrvSampleTable(PrvGetAdaptiveTable(), X * PrvAdaptiveTableResolution / PrvAdaptiveTableMaxX);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FPrvDampingCorrectionTable
+
+void FPrvDampingCorrectionTable::Build(float InStiffness, float InDamping, float Mass, float CorrectionFactor)
+{
+	Stiffness = InStiffness;
+	Damping = InDamping;
+
+	VelocityScale.SetNumUninitialized(Resolution + 1);
+
+	// Correction ratio tends to one when DeltaTime tends to zero
+	VelocityScale[0] = 1.f / 100.f;
+
+	for (int32 Index = 1; Index <= Resolution; ++Index)
+	{
+		VelocityScale[Index] = FPrvDampingCorrection::CalcVelocityScale(Stiffness, Damping, Mass, MaxDeltaTime * Index / Resolution, CorrectionFactor);
+	}
+}
+
+float FPrvDampingCorrectionTable::GetVelocityScale(float DeltaTime) const
+{
+	return PrvSampleTable(VelocityScale, DeltaTime * Resolution / MaxDeltaTime);
+}
@@ -0,0 +1,234 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#include "PrvGroundGrid.h"
+
+#include "PrvPlugin.h"
+
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/Paths.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+#include "Serialization/MemoryReader.h"
+
+//////////////////////////////////////////////////////////////////////////
+// Format
+
+int64 FPrvGroundGridHeader::GetTileDataSize() const
+{
+	return static_cast<int64>(GetTileSamplesNum()) * sizeof(FPrvGroundCell);
+}
+
+FVector FPrvGroundCell::GetNormal() const
+{
+	const float X = NormalX / 127.f;
+	const float Y = NormalY / 127.f;
+	const float Z = FMath::Sqrt(FMath::Max(0.f, 1.f - X * X - Y * Y));
+	return FVector(X, Y, Z).GetSafeNormal();
+}
+
+void FPrvGroundCell::SetNormal(const FVector& Normal)
+{
+	NormalX = static_cast<int8>(FMath::Clamp(FMath::RoundToInt(Normal.X * 127.f), -127, 127));
+	NormalY = static_cast<int8>(FMath::Clamp(FMath::RoundToInt(Normal.Y * 127.f), -127, 127));
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FPrvGroundGrid
+
+FPrvGroundGrid::FPrvGroundGrid()
+	: MaxResidentTiles(256)
+{
+}
+
+FPrvGroundGrid::~FPrvGroundGrid()
+{
+	Close();
+}
+
+bool FPrvGroundGrid::Open(const FString& FilePath)
+{
+	Close();
+
+	IMappedFileHandle* MappedFile = FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*FilePath);
+	if (MappedFile == nullptr)
+	{
+		return false;
+	}
+
+	FileHandle.Reset(MappedFile);
+
+	// Header and tile offsets are needed for every lookup, copy them once
+	{
+		TUniquePtr<IMappedFileRegion> HeaderRegion(FileHandle->MapRegion(0, sizeof(FPrvGroundGridHeader)));
+		if (!HeaderRegion.IsValid() || FileHandle->GetFileSize() < static_cast<int64>(sizeof(FPrvGroundGridHeader)))
+		{
+			UE_LOG(LogPrvVehicle, Error, TEXT("Ground grid open failed: Can't read header: %s"), *FilePath);
+			Close();
+			return false;
+		}
+
+		FMemory::Memcpy(&Header, HeaderRegion->GetMappedPtr(), sizeof(FPrvGroundGridHeader));
+	}
+
+	if (Header.Magic != FPrvGroundGridHeader::FileMagic || Header.Version != FPrvGroundGridHeader::FileVersion || Header.GetTilesNum() <= 0 || Header.CellSize <= 0.f)
+	{
+		UE_LOG(LogPrvVehicle, Error, TEXT("Ground grid open failed: Invalid file: %s"), *FilePath);
+		Close();
+		return false;
+	}
+
+	{
+		TileOffsets.SetNumUninitialized(Header.GetTilesNum());
+		TUniquePtr<IMappedFileRegion> OffsetsRegion(FileHandle->MapRegion(Header.GetTileOffsetsOffset(), TileOffsets.Num() * sizeof(int64)));
+		if (!OffsetsRegion.IsValid())
+		{
+			Close();
+			return false;
+		}
+
+		FMemory::Memcpy(TileOffsets.GetData(), OffsetsRegion->GetMappedPtr(), TileOffsets.Num() * sizeof(int64));
+	}
+
+	// Physical materials are stored as object paths
+	if (Header.MaterialsNum > 0 && Header.MaterialsOffset > 0)
+	{
+		TUniquePtr<IMappedFileRegion> MaterialsRegion(FileHandle->MapRegion(Header.MaterialsOffset, FileHandle->GetFileSize() - Header.MaterialsOffset));
+		if (MaterialsRegion.IsValid())
+		{
+			TArray<uint8> MaterialsData(MaterialsRegion->GetMappedPtr(), static_cast<int32>(MaterialsRegion->GetMappedSize()));
+			FMemoryReader Reader(MaterialsData);
+
+			TArray<FString> MaterialPaths;
+			Reader << MaterialPaths;
+
+			for (const FString& MaterialPath : MaterialPaths)
+			{
+				Materials.Add(LoadObject<UPhysicalMaterial>(nullptr, *MaterialPath));
+			}
+		}
+	}
+
+	UE_LOG(LogPrvVehicle, Log, TEXT("Ground grid mapped: %s (%dx%d tiles, %d cells per tile, %d layers)"), *FilePath, Header.TilesX, Header.TilesY, Header.TileCells, Header.Layers);
+
+	return true;
+}
+
+void FPrvGroundGrid::Close()
+{
+	ResidentTiles.Empty();
+	TileOffsets.Empty();
+	Materials.Empty();
+	FileHandle.Reset();
+	Header = FPrvGroundGridHeader();
+}
+
+bool FPrvGroundGrid::Sample(const FVector& Location, FVector& OutPoint, FVector& OutNormal, uint8& OutSurfaceType, UPhysicalMaterial*& OutPhysMaterial)
+{
+	if (!IsOpen())
+	{
+		return false;
+	}
+
+	const int32 CellX = FMath::FloorToInt((Location.X - Header.OriginX) / Header.CellSize);
+	const int32 CellY = FMath::FloorToInt((Location.Y - Header.OriginY) / Header.CellSize);
+	const int32 TileX = (CellX >= 0) ? CellX / Header.TileCells : -1;
+	const int32 TileY = (CellY >= 0) ? CellY / Header.TileCells : -1;
+	if (TileX < 0 || TileY < 0 || TileX >= Header.TilesX || TileY >= Header.TilesY)
+	{
+		return false;
+	}
+
+	const FPrvGroundCell* TileCells = GetTileCells(TileY * Header.TilesX + TileX);
+	if (TileCells == nullptr)
+	{
+		return false;
+	}
+
+	const int32 LocalX = CellX - TileX * Header.TileCells;
+	const int32 LocalY = CellY - TileY * Header.TileCells;
+	const FPrvGroundCell* CellLayers = TileCells + (LocalY * Header.TileCells + LocalX) * Header.Layers;
+
+	// Layers go from top to bottom: take the first one below the location
+	for (int32 LayerIdx = 0; LayerIdx < Header.Layers; ++LayerIdx)
+	{
+		const FPrvGroundCell& Cell = CellLayers[LayerIdx];
+		if (!Cell.IsValid())
+		{
+			break;
+		}
+
+		if (Cell.Height <= Location.Z)
+		{
+			const float CellCenterX = Header.OriginX + (CellX + 0.5f) * Header.CellSize;
+			const float CellCenterY = Header.OriginY + (CellY + 0.5f) * Header.CellSize;
+
+			OutPoint = FVector(CellCenterX, CellCenterY, Cell.Height);
+			OutNormal = Cell.GetNormal();
+			OutSurfaceType = Cell.SurfaceType;
+			OutPhysMaterial = Materials.IsValidIndex(Cell.MaterialIndex) ? Materials[Cell.MaterialIndex] : nullptr;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void FPrvGroundGrid::SetMaxResidentTiles(int32 InMaxResidentTiles)
+{
+	MaxResidentTiles = FMath::Max(1, InMaxResidentTiles);
+	TrimResidentTiles(MaxResidentTiles);
+}
+
+FString FPrvGroundGrid::GetGridFilePath(const FString& MapName)
+{
+	return FPaths::ProjectContentDir() / TEXT("PrvGroundGrid") / (MapName + TEXT(".prvgrid"));
+}
+
+const FPrvGroundCell* FPrvGroundGrid::GetTileCells(int32 TileIndex)
+{
+	const int64 TileOffset = TileOffsets[TileIndex];
+	if (TileOffset <= 0)
+	{
+		return nullptr;
+	}
+
+	if (FResidentTile* ResidentTile = ResidentTiles.Find(TileIndex))
+	{
+		ResidentTile->LastUsedFrame = GFrameCounter;
+		return reinterpret_cast<const FPrvGroundCell*>(ResidentTile->Region->GetMappedPtr());
+	}
+
+	// Keep memory bounded: drop old tiles before mapping the new one
+	TrimResidentTiles(MaxResidentTiles - 1);
+
+	IMappedFileRegion* Region = FileHandle->MapRegion(TileOffset, Header.GetTileDataSize());
+	if (Region == nullptr)
+	{
+		return nullptr;
+	}
+
+	FResidentTile& NewTile = ResidentTiles.Add(TileIndex);
+	NewTile.Region.Reset(Region);
+	NewTile.LastUsedFrame = GFrameCounter;
+
+	return reinterpret_cast<const FPrvGroundCell*>(Region->GetMappedPtr());
+}
+
+void FPrvGroundGrid::TrimResidentTiles(int32 MaxTiles)
+{
+	while (ResidentTiles.Num() > FMath::Max(0, MaxTiles))
+	{
+		int32 OldestTile = INDEX_NONE;
+		uint64 OldestFrame = MAX_uint64;
+		for (const auto& ResidentTile : ResidentTiles)
+		{
+			if (ResidentTile.Value.LastUsedFrame < OldestFrame)
+			{
+				OldestFrame = ResidentTile.Value.LastUsedFrame;
+				OldestTile = ResidentTile.Key;
+			}
+		}
+
+		ResidentTiles.Remove(OldestTile);
+	}
+}
@@ -0,0 +1,176 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#include "PrvGroundProbe.h"
+
+#include "PrvVehicleMovementComponent.h"
+
+#include "LandscapeHeightfieldCollisionComponent.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+#include "Physics/PhysicsInterfaceCore.h"
+
+#if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
+#include "PhysXPublic.h"
+#endif
+
+bool FPrvGroundProbe::MakePlaneHit(const FPrvWheelProbe& Probe, const FVector& PlanePoint, const FVector& PlaneNormal, FHitResult& OutHit)
+{
+	// Line probe is a point moving from above the wheel to below it
+	const float Radius = Probe.bLineTrace ? 0.f : Probe.Radius;
+	const FVector Start = Probe.bLineTrace ? Probe.Start + Probe.UpVector * Probe.Radius : Probe.Start;
+	const FVector End = Probe.bLineTrace ? Probe.End - Probe.UpVector * Probe.Radius : Probe.End;
+
+	// Probe should move towards the plane
+	const float Approach = FVector::DotProduct(-Probe.UpVector, PlaneNormal);
+	if (Approach <= KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	// Distance along probe to touch the plane with sphere surface
+	const float StartHeight = FVector::DotProduct(Start - PlanePoint, PlaneNormal);
+	const float Distance = (StartHeight - Radius) / Approach;
+	const float MaxDistance = (End - Start).Size();
+	if (Distance > MaxDistance)
+	{
+		return false;
+	}
+
+	const bool bStartPenetrating = (Distance < 0.f);
+
+	OutHit = FHitResult(Start, End);
+	OutHit.bBlockingHit = true;
+	OutHit.bStartPenetrating = bStartPenetrating;
+	OutHit.Distance = FMath::Max(0.f, Distance);
+	OutHit.Time = (MaxDistance > SMALL_NUMBER) ? OutHit.Distance / MaxDistance : 0.f;
+	OutHit.Location = Start - Probe.UpVector * OutHit.Distance;
+	OutHit.ImpactPoint = OutHit.Location - PlaneNormal * Radius;
+	OutHit.Normal = PlaneNormal;
+	OutHit.ImpactNormal = PlaneNormal;
+	OutHit.PenetrationDepth = bStartPenetrating ? -Distance * Approach : 0.f;
+
+	return true;
+}
+
+bool FPrvGroundProbe::SampleLandscape(ULandscapeHeightfieldCollisionComponent* Component, const FVector& Location, bool bComplex, FVector& OutPoint, FVector& OutNormal)
+{
+#if ENGINE_MINOR_VERSION >= 26
+	const FTransform& ComponentTransform = Component->GetComponentTransform();
+	const FVector LocalLocation = ComponentTransform.InverseTransformPosition(Location);
+	const EHeightfieldSource HeightfieldSource = bComplex ? EHeightfieldSource::Complex : EHeightfieldSource::Simple;
+
+	// Heightfield is sampled in quads, so use neighbor quads for the normal
+	auto SamplePoint = [&](float X, float Y, FVector& OutSample) -> bool
+	{
+		const TOptional<float> Height = Component->GetHeight(X, Y, HeightfieldSource);
+		if (!Height.IsSet())
+		{
+			return false;
+		}
+
+		OutSample = ComponentTransform.TransformPosition(FVector(X, Y, Height.GetValue()));
+		return true;
+	};
+
+	FVector Left, Right, Back, Front;
+	if (!SamplePoint(LocalLocation.X, LocalLocation.Y, OutPoint) ||
+		!SamplePoint(LocalLocation.X - 0.5f, LocalLocation.Y, Left) ||
+		!SamplePoint(LocalLocation.X + 0.5f, LocalLocation.Y, Right) ||
+		!SamplePoint(LocalLocation.X, LocalLocation.Y - 0.5f, Back) ||
+		!SamplePoint(LocalLocation.X, LocalLocation.Y + 0.5f, Front))
+	{
+		return false;
+	}
+
+	OutNormal = FVector::CrossProduct(Right - Left, Front - Back).GetSafeNormal();
+	if (FVector::DotProduct(OutNormal, ComponentTransform.GetUnitAxis(EAxis::Z)) < 0.f)
+	{
+		OutNormal = -OutNormal;
+	}
+
+	return !OutNormal.IsNearlyZero();
+#else
+	return false;
+#endif
+}
+
+UPhysicalMaterial* FPrvGroundProbe::GetLandscapePhysicalMaterial(ULandscapeHeightfieldCollisionComponent* Component, const FVector& Location)
+{
+	FBodyInstance* BodyInstance = Component->GetBodyInstance();
+	if (BodyInstance == nullptr)
+	{
+		return nullptr;
+	}
+
+	UPhysicalMaterial* PhysMaterial = nullptr;
+
+#if WITH_PHYSX && PHYSICS_INTERFACE_PHYSX
+	// Layer materials are cooked into heightfield samples, so look them up by the triangle under the location as scene queries do
+	if (Component->CookedPhysicalMaterials.Num() > 0)
+	{
+		FPhysicsCommand::ExecuteRead(BodyInstance->ActorHandle, [&](const FPhysicsActorHandle& Actor)
+		{
+			TArray<FPhysicsShapeHandle> Shapes;
+			BodyInstance->GetAllShapes_AssumesLocked(Shapes);
+
+			const FVector UpVector = Component->GetComponentTransform().GetUnitAxis(EAxis::Z);
+			const float RayHalfLength = 10.f;
+
+			for (const FPhysicsShapeHandle& Shape : Shapes)
+			{
+				physx::PxShape* PShape = Shape.Shape;
+				physx::PxHeightFieldGeometry PGeometry;
+				if (PShape == nullptr || PShape->getActor() == nullptr || !PShape->getHeightFieldGeometry(PGeometry))
+				{
+					continue;
+				}
+
+				const physx::PxTransform PPose = physx::PxShapeExt::getGlobalPose(*PShape, *PShape->getActor());
+
+				physx::PxRaycastHit PHit;
+				const physx::PxU32 HitsNum = physx::PxGeometryQuery::raycast(
+					U2PVector(Location + UpVector * RayHalfLength), U2PVector(-UpVector), PGeometry, PPose,
+					RayHalfLength * 2.f, physx::PxHitFlag::eFACE_INDEX, 1, &PHit);
+
+				if (HitsNum > 0)
+				{
+					const physx::PxMaterial* PMaterial = PShape->getMaterialFromInternalFaceIndex(PHit.faceIndex);
+					PhysMaterial = PMaterial ? FPhysxUserData::Get<UPhysicalMaterial>(PMaterial->userData) : nullptr;
+					if (PhysMaterial)
+					{
+						break;
+					}
+				}
+			}
+		});
+	}
+#endif
+
+	return PhysMaterial ? PhysMaterial : BodyInstance->GetSimplePhysicalMaterial();
+}
+
+bool FPrvGroundProbe::TraceLandscape(ULandscapeHeightfieldCollisionComponent* Component, const FPrvWheelProbe& Probe, bool bComplex, FHitResult& OutHit)
+{
+	// Use ground under the probe start as the first guess
+	FVector GroundPoint, GroundNormal;
+	if (!SampleLandscape(Component, Probe.Start, bComplex, GroundPoint, GroundNormal))
+	{
+		return false;
+	}
+
+	if (!MakePlaneHit(Probe, GroundPoint, GroundNormal, OutHit))
+	{
+		return false;
+	}
+
+	// Refine with ground under the contact point
+	if (!SampleLandscape(Component, OutHit.ImpactPoint, bComplex, GroundPoint, GroundNormal) || !MakePlaneHit(Probe, GroundPoint, GroundNormal, OutHit))
+	{
+		return false;
+	}
+
+	OutHit.Component = Component;
+	OutHit.Actor = Component->GetOwner();
+	OutHit.PhysMaterial = GetLandscapePhysicalMaterial(Component, OutHit.ImpactPoint);
+
+	return true;
+}
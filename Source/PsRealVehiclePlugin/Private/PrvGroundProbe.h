@@ -0,0 +1,25 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#pragma once
+
+#include "PrvPlugin.h"
+
+struct FPrvWheelProbe;
+class ULandscapeHeightfieldCollisionComponent;
+class UPhysicalMaterial;
+
+/** Wheel contact helpers for ground data that doesn't need scene queries */
+struct FPrvGroundProbe
+{
+	/** Find where wheel probe touches the plane. Returns false if the plane is out of probe range */
+	static bool MakePlaneHit(const FPrvWheelProbe& Probe, const FVector& PlanePoint, const FVector& PlaneNormal, FHitResult& OutHit);
+
+	/** Sample landscape collision heightfield under the probe. Returns false if probe isn't over the component */
+	static bool SampleLandscape(ULandscapeHeightfieldCollisionComponent* Component, const FVector& Location, bool bComplex, FVector& OutPoint, FVector& OutNormal);
+
+	/** Physical material of the landscape layer at the location. Falls back to the component material if heightfield has no layer data */
+	static UPhysicalMaterial* GetLandscapePhysicalMaterial(ULandscapeHeightfieldCollisionComponent* Component, const FVector& Location);
+
+	/** Probe wheel against landscape collision heightfield */
+	static bool TraceLandscape(ULandscapeHeightfieldCollisionComponent* Component, const FPrvWheelProbe& Probe, bool bComplex, FHitResult& OutHit);
+};
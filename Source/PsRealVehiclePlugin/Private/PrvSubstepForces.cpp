@@ -0,0 +1,227 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#include "PrvSubstepForces.h"
+
+#include "PrvGroundProbe.h"
+#include "PrvSuspensionKernel.h"
+
+#include "Physics/PhysicsInterfaceCore.h"
+#include "PhysicsEngine/BodyInstance.h"
+
+FPrvSubstepForces::FPrvSubstepForces()
+	: bPendingInput(false)
+{
+}
+
+void FPrvSubstepForces::PublishInput()
+{
+	FScopeLock Lock(&InputLock);
+	PendingInput = GameInput;
+	bPendingInput = true;
+}
+
+bool FPrvSubstepForces::UpdateOutput()
+{
+	FScopeLock Lock(&OutputLock);
+	if (FrontOutput.SubstepsNum == 0)
+	{
+		return false;
+	}
+
+	GameOutput = FrontOutput;
+	FrontOutput.SubstepsNum = 0;
+	return true;
+}
+
+void FPrvSubstepForces::ResetOutput()
+{
+	FScopeLock Lock(&OutputLock);
+	FrontOutput.SubstepsNum = 0;
+	GameOutput.SubstepsNum = 0;
+}
+
+void FPrvSubstepForces::Substep(float DeltaTime, FBodyInstance* BodyInstance)
+{
+	if (DeltaTime <= SMALL_NUMBER || BodyInstance == nullptr)
+	{
+		return;
+	}
+
+	{
+		FScopeLock Lock(&InputLock);
+		if (bPendingInput)
+		{
+			Swap(Input, PendingInput);
+			bPendingInput = false;
+		}
+	}
+
+	const int32 WheelsNum = Input.Wheels.Num();
+	if (WheelsNum == 0)
+	{
+		return;
+	}
+
+	// Wheels config has changed or substeps were paused, start from the game thread state
+	const bool bResetState = Input.bResetState || (Sim.Num() != WheelsNum);
+	Input.bResetState = false;
+
+	if (Sim.Num() != WheelsNum)
+	{
+		Sim.SetNum(WheelsNum);
+		RotationAngle.SetNum(WheelsNum);
+	}
+
+	const FPhysicsActorHandle& ActorHandle = BodyInstance->GetPhysicsActorHandle();
+	const FTransform ComponentTransform = Input.ComponentToBody * BodyInstance->GetUnrealWorldTransform_AssumesLocked();
+	const FVector CenterOfMass = FPhysicsInterface::GetComTransform_AssumesLocked(ActorHandle).GetLocation();
+	const float Mass = FPhysicsInterface::GetMass_AssumesLocked(ActorHandle);
+	const FVector LinearVelocity = BodyInstance->GetUnrealWorldVelocity_AssumesLocked();
+	const FVector AngularVelocity = BodyInstance->GetUnrealWorldAngularVelocityInRadians_AssumesLocked();
+	const FVector ForwardVector = ComponentTransform.GetUnitAxis(EAxis::X);
+	const FVector RightVector = ComponentTransform.GetUnitAxis(EAxis::Y);
+
+	BackOutput.ContactDistance.SetNum(WheelsNum, false);
+	BackOutput.Force.SetNum(WheelsNum, false);
+	BackOutput.FrictionForce.SetNum(WheelsNum, false);
+	BackOutput.RotationAngle.SetNum(WheelsNum, false);
+
+	// Probe contact planes with the substep pose
+	int32 ContactsNum = 0;
+	int32 DrivenContactsNum = 0;
+	for (int32 WheelIdx = 0; WheelIdx < WheelsNum; ++WheelIdx)
+	{
+		const FPrvSubstepWheelInput& Wheel = Input.Wheels[WheelIdx];
+
+		Sim.Length[WheelIdx] = Wheel.Length;
+		Sim.InvLength[WheelIdx] = (Wheel.Length > SMALL_NUMBER) ? (1.f / Wheel.Length) : 0.f;
+		Sim.Stiffness[WheelIdx] = Wheel.Stiffness;
+		Sim.CompressionDamping[WheelIdx] = Wheel.CompressionDamping;
+		Sim.DecompressionDamping[WheelIdx] = Wheel.DecompressionDamping;
+
+		if (bResetState)
+		{
+			Sim.PreviousLength[WheelIdx] = Wheel.PreviousLength;
+			RotationAngle[WheelIdx] = Wheel.RotationAngle;
+		}
+
+		FPrvWheelProbe Probe = Wheel.LocalProbe;
+		Probe.MeshTransform = ComponentTransform;
+		Probe.Start = ComponentTransform.TransformPosition(Wheel.LocalProbe.Start);
+		Probe.End = ComponentTransform.TransformPosition(Wheel.LocalProbe.End);
+		Probe.UpVector = ComponentTransform.TransformVectorNoScale(Wheel.LocalProbe.UpVector);
+		Probe.Rotation = ComponentTransform.GetRotation() * Wheel.LocalProbe.Rotation;
+
+		Sim.ProbeOrigin[WheelIdx] = Probe.Start;
+		Sim.ProbeDirection[WheelIdx] = Probe.UpVector;
+
+		FHitResult Hit;
+		const bool bHit = Wheel.bContact && FPrvGroundProbe::MakePlaneHit(Probe, Wheel.ContactPoint, Wheel.ContactNormal, Hit);
+
+		Sim.Contact[WheelIdx] = bHit ? 1 : 0;
+		Sim.ContactLength[WheelIdx] = bHit ? FMath::Clamp(Hit.Distance, 0.f, Wheel.Length) : Wheel.Length;
+		Sim.ContactLocation[WheelIdx] = bHit ? Hit.ImpactPoint : FVector::ZeroVector;
+		Sim.ContactNormal[WheelIdx] = bHit ? Hit.ImpactNormal : FVector::UpVector;
+
+		BackOutput.ContactDistance[WheelIdx] = bHit ? Hit.Distance : -1.f;
+		ContactsNum += bHit ? 1 : 0;
+		DrivenContactsNum += (bHit && Wheel.bDriven) ? 1 : 0;
+	}
+
+	FPrvSuspensionKernel::PrepareSpringDamper(Sim, 1.f / DeltaTime);
+
+	// Substeps are short enough to go without damping correction
+	float ImplicitDeltaTime = 0.f;
+	float InvWheelMass = 0.f;
+	if (Input.bImplicit && Mass > SMALL_NUMBER)
+	{
+		ImplicitDeltaTime = DeltaTime;
+		InvWheelMass = ContactsNum / Mass;
+
+		for (int32 WheelIdx = 0; WheelIdx < WheelsNum; ++WheelIdx)
+		{
+			if (Sim.Contact[WheelIdx] != 0)
+			{
+				Sim.Velocity[WheelIdx] += Input.GravityZ * Sim.ProbeDirection[WheelIdx].Z * DeltaTime;
+			}
+		}
+	}
+
+	FPrvSuspensionKernel::SolveSpringDamper(Sim, Input.bClampForce, ImplicitDeltaTime, InvWheelMass);
+
+	// Track drive forces follow the substep pose
+	const float DriveForceScale = (Input.bScaleDriveForce && DrivenContactsNum > 0) ? static_cast<float>(WheelsNum) / DrivenContactsNum : 1.f;
+	const FVector DriveForce[2] = {
+		ComponentTransform.TransformVectorNoScale(Input.LocalDriveForce[0]) * DriveForceScale,
+		ComponentTransform.TransformVectorNoScale(Input.LocalDriveForce[1]) * DriveForceScale};
+
+	// Side slip is damped at the center of mass
+	FVector Force = -FVector::DotProduct(RightVector, LinearVelocity) * RightVector * Input.AntiSlipFactor;
+	FVector Torque = FVector::ZeroVector;
+
+	float MinTrackAngularSpeed[2] = {BIG_NUMBER, BIG_NUMBER};
+
+	// Sum wheel forces into one force and torque
+	for (int32 WheelIdx = 0; WheelIdx < WheelsNum; ++WheelIdx)
+	{
+		const FPrvSubstepWheelInput& Wheel = Input.Wheels[WheelIdx];
+		const int32 Track = Wheel.bRightTrack ? 1 : 0;
+
+		// Wheels rotate with their track
+		RotationAngle[WheelIdx] = FRotator::NormalizeAxis(RotationAngle[WheelIdx] - FMath::RadiansToDegrees(Input.TrackAngularSpeed[Track]) * DeltaTime * Input.WheelRotationRatio);
+
+		BackOutput.RotationAngle[WheelIdx] = RotationAngle[WheelIdx];
+		BackOutput.Force[WheelIdx] = Sim.Force[WheelIdx];
+		BackOutput.FrictionForce[WheelIdx] = FVector::ZeroVector;
+
+		if (Sim.Contact[WheelIdx] == 0)
+		{
+			continue;
+		}
+
+		const FVector& ContactLocation = Sim.ContactLocation[WheelIdx];
+		const FVector& ContactNormal = Sim.ContactNormal[WheelIdx];
+
+		// Suspension
+		const FVector SuspensionDirection = Input.bWheeledVehicle ? ContactNormal : Sim.ProbeDirection[WheelIdx];
+		const FVector SuspensionForce = Sim.Force[WheelIdx] * SuspensionDirection;
+		Force += SuspensionForce;
+		Torque += FVector::CrossProduct(Sim.ProbeOrigin[WheelIdx] - CenterOfMass, SuspensionForce);
+
+		// Drive force is limited by wheel load
+		if (Wheel.bDriven)
+		{
+			const float WheelLoad = FMath::Abs(FVector::DotProduct(SuspensionForce, ContactNormal));
+			const FVector FrictionForce = FVector::VectorPlaneProject(DriveForce[Track], ContactNormal).GetClampedToMaxSize(WheelLoad) * Input.DriveForceMultiplier;
+
+			BackOutput.FrictionForce[WheelIdx] = FrictionForce;
+			Force += FrictionForce;
+			Torque += FVector::CrossProduct(ContactLocation - CenterOfMass, FrictionForce);
+		}
+
+		// Track is as fast as its slowest wheel on the ground
+		if (Input.SprocketRadius > SMALL_NUMBER)
+		{
+			const FVector PointVelocity = LinearVelocity + FVector::CrossProduct(AngularVelocity, ContactLocation - CenterOfMass);
+			MinTrackAngularSpeed[Track] = FMath::Min(MinTrackAngularSpeed[Track], FVector::DotProduct(PointVelocity, ForwardVector) / Input.SprocketRadius);
+		}
+	}
+
+	for (int32 Track = 0; Track < 2; ++Track)
+	{
+		BackOutput.bTrackContact[Track] = (MinTrackAngularSpeed[Track] < BIG_NUMBER);
+		BackOutput.TrackAngularSpeed[Track] = BackOutput.bTrackContact[Track] ? MinTrackAngularSpeed[Track] : 0.f;
+	}
+
+	BackOutput.EngineRPM = PrvSpeedToEngineRPM(Input.TransmissionRatio, LinearVelocity.Size(), Input.MinEngineRPM, Input.MaxEngineRPM);
+
+	// Forces are for this substep only
+	BodyInstance->AddForce(Force, /*bAllowSubstepping*/ false);
+	BodyInstance->AddTorqueInRadians(Torque, /*bAllowSubstepping*/ false);
+
+	{
+		FScopeLock Lock(&OutputLock);
+		BackOutput.SubstepsNum = FrontOutput.SubstepsNum + 1;
+		Swap(BackOutput, FrontOutput);
+	}
+}
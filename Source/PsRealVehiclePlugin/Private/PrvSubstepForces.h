@@ -0,0 +1,204 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#pragma once
+
+#include "PrvPlugin.h"
+
+#include "PrvSuspensionSimData.h"
+#include "PrvVehicleMovementComponent.h"
+
+#include "HAL/CriticalSection.h"
+
+struct FBodyInstance;
+
+/** Wheel data substeps need from the game thread */
+struct FPrvSubstepWheelInput
+{
+	/** Wheel probe in component space */
+	FPrvWheelProbe LocalProbe;
+
+	/** Ground plane the wheel touched on the last game thread probe */
+	FVector ContactPoint;
+	FVector ContactNormal;
+	bool bContact;
+
+	/** Suspension config (global factors applied) */
+	float Length;
+	float Stiffness;
+	float CompressionDamping;
+	float DecompressionDamping;
+
+	/** Effective suspension length to start from if substeps have no state yet */
+	float PreviousLength;
+
+	/** Wheel rotation to start from if substeps have no state yet */
+	float RotationAngle;
+
+	/** Wheel belongs to the right track */
+	bool bRightTrack;
+
+	/** Wheel transfers drive force */
+	bool bDriven;
+
+	FPrvSubstepWheelInput()
+		: ContactPoint(FVector::ZeroVector)
+		, ContactNormal(FVector::UpVector)
+		, bContact(false)
+		, Length(0.f)
+		, Stiffness(0.f)
+		, CompressionDamping(0.f)
+		, DecompressionDamping(0.f)
+		, PreviousLength(0.f)
+		, RotationAngle(0.f)
+		, bRightTrack(false)
+		, bDriven(false)
+	{
+	}
+};
+
+/** Vehicle data substeps need from the game thread, written once per frame */
+struct FPrvSubstepInput
+{
+	TArray<FPrvSubstepWheelInput> Wheels;
+
+	/** Updated component transform relative to the body, so substeps work in the same space as game thread suspension */
+	FTransform ComponentToBody;
+
+	/** Drive force of each track (left, right) in component space */
+	FVector LocalDriveForce[2];
+
+	/** Effective angular speed of each track (left, right) to rotate wheels with */
+	float TrackAngularSpeed[2];
+
+	float GravityZ;
+	float SprocketRadius;
+
+	/** Sprocket radius to visual wheel radius */
+	float WheelRotationRatio;
+
+	float AntiSlipFactor;
+	float DriveForceMultiplier;
+
+	/** Current gear ratio with differential and engine RPM limits */
+	float TransmissionRatio;
+	float MinEngineRPM;
+	float MaxEngineRPM;
+
+	/** Suspension force is applied along contact normal instead of suspension direction */
+	bool bWheeledVehicle;
+
+	bool bClampForce;
+	bool bImplicit;
+
+	/** Drive force is scaled up when not all driven wheels touch the ground */
+	bool bScaleDriveForce;
+
+	/** Substeps should start from this input state instead of their own */
+	bool bResetState;
+
+	FPrvSubstepInput()
+		: ComponentToBody(FTransform::Identity)
+		, GravityZ(0.f)
+		, SprocketRadius(0.f)
+		, WheelRotationRatio(0.f)
+		, AntiSlipFactor(0.f)
+		, DriveForceMultiplier(0.f)
+		, TransmissionRatio(0.f)
+		, MinEngineRPM(0.f)
+		, MaxEngineRPM(0.f)
+		, bWheeledVehicle(false)
+		, bClampForce(false)
+		, bImplicit(false)
+		, bScaleDriveForce(false)
+		, bResetState(false)
+	{
+		LocalDriveForce[0] = LocalDriveForce[1] = FVector::ZeroVector;
+		TrackAngularSpeed[0] = TrackAngularSpeed[1] = 0.f;
+	}
+};
+
+/** Substep results published back to the game thread */
+struct FPrvSubstepOutput
+{
+	/** Probe distance of each wheel, negative without contact */
+	TArray<float> ContactDistance;
+
+	/** Spring-damper force of each wheel on the last substep */
+	TArray<float> Force;
+
+	/** Drive force of each wheel on the last substep */
+	TArray<FVector> FrictionForce;
+
+	/** Wheel rotation angle of each wheel */
+	TArray<float> RotationAngle;
+
+	/** Angular speed of each track (left, right) from ground velocity under its wheels */
+	float TrackAngularSpeed[2];
+
+	/** Track has wheels on the ground */
+	bool bTrackContact[2];
+
+	/** Engine RPM from the body speed of the last substep */
+	float EngineRPM;
+
+	/** Substeps made since the game thread read the output */
+	int32 SubstepsNum;
+
+	FPrvSubstepOutput()
+		: EngineRPM(0.f)
+		, SubstepsNum(0)
+	{
+		TrackAngularSpeed[0] = TrackAngularSpeed[1] = 0.f;
+		bTrackContact[0] = bTrackContact[1] = false;
+	}
+};
+
+/**
+ * Suspension, friction and drive forces evaluated on each physics substep with the body pose of that substep.
+ * Ground contacts come from game thread probes as planes, so no scene queries are made here.
+ * Drivetrain stays on the game thread and passes track drive forces with input.
+ * Substep() runs on the physics thread and doesn't touch any UObject.
+ */
+class FPrvSubstepForces
+{
+public:
+	FPrvSubstepForces();
+
+	/** Game thread: input to fill for the next substeps, it's kept between frames so arrays are reused */
+	FPrvSubstepInput& GetInput() { return GameInput; }
+
+	/** Game thread: pass filled input to the next substeps */
+	void PublishInput();
+
+	/** Game thread: take results of the substeps made since the last call. Returns false if there were none (last results are kept) */
+	bool UpdateOutput();
+
+	/** Game thread: drop results, so they aren't used until new substeps are made */
+	void ResetOutput();
+
+	/** Game thread: results taken by UpdateOutput() */
+	const FPrvSubstepOutput& GetOutput() const { return GameOutput; }
+
+	/** Physics thread: add vehicle forces for one substep */
+	void Substep(float DeltaTime, FBodyInstance* BodyInstance);
+
+private:
+	/** Input written by the game thread */
+	FPrvSubstepInput GameInput;
+	FCriticalSection InputLock;
+	FPrvSubstepInput PendingInput;
+	bool bPendingInput;
+
+	/** Physics thread copy of input and simulation state */
+	FPrvSubstepInput Input;
+	FPrvSuspensionSimData Sim;
+	TArray<float> RotationAngle;
+
+	/** Output buffers: back one is written by the physics thread, front one is read by the game thread */
+	FCriticalSection OutputLock;
+	FPrvSubstepOutput BackOutput;
+	FPrvSubstepOutput FrontOutput;
+
+	/** Game thread copy of output */
+	FPrvSubstepOutput GameOutput;
+};
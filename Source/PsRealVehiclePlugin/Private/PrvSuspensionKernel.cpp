@@ -0,0 +1,194 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#include "PrvSuspensionKernel.h"
+
+#include "PrvSuspensionSimData.h"
+
+#include "Math/VectorRegister.h"
+
+/** Lanes of VectorRegister */
+static constexpr int32 PrvSimdWidth = 4;
+
+/** All lanes set for wheels with ground contact */
+static FORCEINLINE VectorRegister PrvLoadContactMask(const uint8* Contact)
+{
+	const VectorRegister ContactValue = MakeVectorRegister((float)Contact[0], (float)Contact[1], (float)Contact[2], (float)Contact[3]);
+	return VectorCompareGT(ContactValue, VectorZero());
+}
+
+static bool PrvNearlyEqual(float A, float B, float Tolerance)
+{
+	return FMath::Abs(A - B) <= Tolerance * FMath::Max3(1.f, FMath::Abs(A), FMath::Abs(B));
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Prepare
+
+void FPrvSuspensionKernel::PrepareSpringDamper(FPrvSuspensionSimData& Sim, float InvDeltaTime)
+{
+	const int32 SimdNum = Sim.Num() - Sim.Num() % PrvSimdWidth;
+
+	const VectorRegister VecInvDeltaTime = VectorSetFloat1(InvDeltaTime);
+	const VectorRegister VecZero = VectorZero();
+	const VectorRegister VecOne = VectorOne();
+
+	for (int32 Index = 0; Index < SimdNum; Index += PrvSimdWidth)
+	{
+		const VectorRegister ContactMask = PrvLoadContactMask(&Sim.Contact[Index]);
+
+		const VectorRegister Length = VectorLoad(&Sim.Length[Index]);
+		const VectorRegister InvLength = VectorLoad(&Sim.InvLength[Index]);
+		const VectorRegister ContactLength = VectorLoad(&Sim.ContactLength[Index]);
+		const VectorRegister PreviousLength = VectorLoad(&Sim.PreviousLength[Index]);
+
+		// Spring compression ratio
+		VectorRegister Compression = VectorMultiply(VectorSubtract(Length, ContactLength), InvLength);
+		Compression = VectorMin(VectorMax(Compression, VecZero), VecOne);
+
+		// Discrete suspension velocity
+		const VectorRegister Velocity = VectorMultiply(VectorSubtract(ContactLength, PreviousLength), VecInvDeltaTime);
+
+		// Compression and decompression have different suspension quality
+		const VectorRegister CompressionMask = VectorCompareGT(VecZero, Velocity);
+		const VectorRegister Damping = VectorSelect(CompressionMask, VectorLoad(&Sim.CompressionDamping[Index]), VectorLoad(&Sim.DecompressionDamping[Index]));
+
+		VectorStore(VectorSelect(ContactMask, Compression, VecZero), &Sim.Compression[Index]);
+		VectorStore(VectorSelect(ContactMask, Velocity, VecZero), &Sim.Velocity[Index]);
+		VectorStore(VectorSelect(ContactMask, Damping, VecZero), &Sim.Damping[Index]);
+	}
+
+	PrepareSpringDamperScalar(Sim, InvDeltaTime, SimdNum);
+}
+
+void FPrvSuspensionKernel::PrepareSpringDamperScalar(FPrvSuspensionSimData& Sim, float InvDeltaTime, int32 StartIndex)
+{
+	for (int32 Index = StartIndex; Index < Sim.Num(); ++Index)
+	{
+		if (Sim.Contact[Index] == 0)
+		{
+			Sim.Compression[Index] = 0.f;
+			Sim.Velocity[Index] = 0.f;
+			Sim.Damping[Index] = 0.f;
+			continue;
+		}
+
+		const float Velocity = (Sim.ContactLength[Index] - Sim.PreviousLength[Index]) * InvDeltaTime;
+
+		Sim.Compression[Index] = FMath::Clamp((Sim.Length[Index] - Sim.ContactLength[Index]) * Sim.InvLength[Index], 0.f, 1.f);
+		Sim.Velocity[Index] = Velocity;
+		Sim.Damping[Index] = (Velocity < 0.f) ? Sim.CompressionDamping[Index] : Sim.DecompressionDamping[Index];
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Solve
+
+void FPrvSuspensionKernel::SolveSpringDamper(FPrvSuspensionSimData& Sim, bool bClampForce, float ImplicitDeltaTime, float InvWheelMass)
+{
+	const int32 SimdNum = Sim.Num() - Sim.Num() % PrvSimdWidth;
+
+	const VectorRegister VecZero = VectorZero();
+	const VectorRegister VecOne = VectorOne();
+	const VectorRegister VecMinForce = VectorSetFloat1(bClampForce ? 0.f : -BIG_NUMBER);
+	const VectorRegister VecImplicitDeltaTime = VectorSetFloat1(ImplicitDeltaTime);
+	const VectorRegister VecImplicitResponse = VectorSetFloat1(ImplicitDeltaTime * InvWheelMass);
+
+	for (int32 Index = 0; Index < SimdNum; Index += PrvSimdWidth)
+	{
+		const VectorRegister ContactMask = PrvLoadContactMask(&Sim.Contact[Index]);
+
+		// Force = ((TargetVelocity - Velocity) * ImplicitDamping + Compression * Stiffness) / ImplicitResponse, target velocity is zero
+		const VectorRegister SpringRate = VectorMultiply(VectorLoad(&Sim.Stiffness[Index]), VectorLoad(&Sim.InvLength[Index]));
+		const VectorRegister ImplicitDamping = VectorMultiplyAdd(SpringRate, VecImplicitDeltaTime, VectorLoad(&Sim.Damping[Index]));
+		const VectorRegister ImplicitResponse = VectorMultiplyAdd(ImplicitDamping, VecImplicitResponse, VecOne);
+
+		const VectorRegister SpringForce = VectorMultiply(VectorLoad(&Sim.Compression[Index]), VectorLoad(&Sim.Stiffness[Index]));
+		const VectorRegister DamperForce = VectorMultiply(VectorLoad(&Sim.Velocity[Index]), ImplicitDamping);
+		const VectorRegister Force = VectorMax(VectorDivide(VectorSubtract(SpringForce, DamperForce), ImplicitResponse), VecMinForce);
+
+		VectorStore(VectorSelect(ContactMask, Force, VecZero), &Sim.Force[Index]);
+		VectorStore(VectorSelect(ContactMask, VectorLoad(&Sim.ContactLength[Index]), VectorLoad(&Sim.Length[Index])), &Sim.PreviousLength[Index]);
+	}
+
+	SolveSpringDamperScalar(Sim, bClampForce, ImplicitDeltaTime, InvWheelMass, SimdNum);
+}
+
+void FPrvSuspensionKernel::SolveSpringDamperScalar(FPrvSuspensionSimData& Sim, bool bClampForce, float ImplicitDeltaTime, float InvWheelMass, int32 StartIndex)
+{
+	for (int32 Index = StartIndex; Index < Sim.Num(); ++Index)
+	{
+		if (Sim.Contact[Index] == 0)
+		{
+			Sim.Force[Index] = 0.f;
+			Sim.PreviousLength[Index] = Sim.Length[Index];
+			continue;
+		}
+
+		// Backward Euler step of the wheel mass: spring acts through damping over the step,
+		// and the force is scaled down by mass response, so it can't overshoot at low tick rate
+		const float SpringRate = Sim.Stiffness[Index] * Sim.InvLength[Index];
+		const float ImplicitDamping = Sim.Damping[Index] + SpringRate * ImplicitDeltaTime;
+		const float ImplicitResponse = 1.f + ImplicitDamping * ImplicitDeltaTime * InvWheelMass;
+
+		const float TargetVelocity = 0.f; // @todo Target velocity can be different for wheeled vehicles
+		float Force = ((TargetVelocity - Sim.Velocity[Index]) * ImplicitDamping + Sim.Compression[Index] * Sim.Stiffness[Index]) / ImplicitResponse;
+
+		if (bClampForce && Force < 0.f)
+		{
+			Force = 0.f;
+		}
+
+		Sim.Force[Index] = Force;
+		Sim.PreviousLength[Index] = Sim.ContactLength[Index];
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Validation
+
+int32 FPrvSuspensionKernel::ValidatePrepareSpringDamper(const FPrvSuspensionSimData& Sim, float InvDeltaTime, float Tolerance)
+{
+	FPrvSuspensionSimData Vectorized = Sim;
+	FPrvSuspensionSimData Reference = Sim;
+
+	PrepareSpringDamper(Vectorized, InvDeltaTime);
+	PrepareSpringDamperScalar(Reference, InvDeltaTime);
+
+	int32 MismatchesNum = 0;
+	for (int32 Index = 0; Index < Sim.Num(); ++Index)
+	{
+		if (!PrvNearlyEqual(Vectorized.Compression[Index], Reference.Compression[Index], Tolerance) ||
+			!PrvNearlyEqual(Vectorized.Velocity[Index], Reference.Velocity[Index], Tolerance) ||
+			!PrvNearlyEqual(Vectorized.Damping[Index], Reference.Damping[Index], Tolerance))
+		{
+			UE_LOG(LogPrvVehicle, Error, TEXT("Spring-damper preparation mismatch on wheel %d: compression %f/%f, velocity %f/%f, damping %f/%f"),
+				Index, Vectorized.Compression[Index], Reference.Compression[Index], Vectorized.Velocity[Index], Reference.Velocity[Index], Vectorized.Damping[Index], Reference.Damping[Index]);
+			MismatchesNum++;
+		}
+	}
+
+	return MismatchesNum;
+}
+
+int32 FPrvSuspensionKernel::ValidateSolveSpringDamper(const FPrvSuspensionSimData& Sim, bool bClampForce, float ImplicitDeltaTime, float InvWheelMass, float Tolerance)
+{
+	FPrvSuspensionSimData Vectorized = Sim;
+	FPrvSuspensionSimData Reference = Sim;
+
+	SolveSpringDamper(Vectorized, bClampForce, ImplicitDeltaTime, InvWheelMass);
+	SolveSpringDamperScalar(Reference, bClampForce, ImplicitDeltaTime, InvWheelMass);
+
+	int32 MismatchesNum = 0;
+	for (int32 Index = 0; Index < Sim.Num(); ++Index)
+	{
+		if (!PrvNearlyEqual(Vectorized.Force[Index], Reference.Force[Index], Tolerance) ||
+			!PrvNearlyEqual(Vectorized.PreviousLength[Index], Reference.PreviousLength[Index], Tolerance))
+		{
+			UE_LOG(LogPrvVehicle, Error, TEXT("Spring-damper solver mismatch on wheel %d: force %f/%f, length %f/%f"),
+				Index, Vectorized.Force[Index], Reference.Force[Index], Vectorized.PreviousLength[Index], Reference.PreviousLength[Index]);
+			MismatchesNum++;
+		}
+	}
+
+	return MismatchesNum;
+}
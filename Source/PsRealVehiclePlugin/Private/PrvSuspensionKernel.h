@@ -0,0 +1,33 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#pragma once
+
+#include "PrvPlugin.h"
+
+struct FPrvSuspensionSimData;
+
+/**
+ * Spring-damper math of all vehicle wheels.
+ * Vectorized versions process four wheels per instruction, scalar versions are the reference
+ * and handle the tail of arrays that isn't multiple of four.
+ */
+struct FPrvSuspensionKernel
+{
+	/** Compression ratio, velocity and damping of each wheel with contact */
+	static void PrepareSpringDamper(FPrvSuspensionSimData& Sim, float InvDeltaTime);
+	static void PrepareSpringDamperScalar(FPrvSuspensionSimData& Sim, float InvDeltaTime, int32 StartIndex = 0);
+
+	/**
+	 * Spring-damper force of each wheel and its length for the next tick.
+	 * Non-zero ImplicitDeltaTime integrates the spring-damper implicitly for the wheel share of vehicle mass
+	 * (InvWheelMass), which keeps stiff suspension stable at low tick rates. Zero gives explicit forces.
+	 */
+	static void SolveSpringDamper(FPrvSuspensionSimData& Sim, bool bClampForce, float ImplicitDeltaTime = 0.f, float InvWheelMass = 0.f);
+	static void SolveSpringDamperScalar(FPrvSuspensionSimData& Sim, bool bClampForce, float ImplicitDeltaTime = 0.f, float InvWheelMass = 0.f, int32 StartIndex = 0);
+
+	/** Compare vectorized preparation with scalar reference on a copy of data. Returns number of mismatched wheels */
+	static int32 ValidatePrepareSpringDamper(const FPrvSuspensionSimData& Sim, float InvDeltaTime, float Tolerance);
+
+	/** Compare vectorized solver with scalar reference on a copy of data. Returns number of mismatched wheels */
+	static int32 ValidateSolveSpringDamper(const FPrvSuspensionSimData& Sim, bool bClampForce, float ImplicitDeltaTime, float InvWheelMass, float Tolerance);
+};
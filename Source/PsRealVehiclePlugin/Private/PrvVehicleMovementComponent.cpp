@@ -5,14 +5,18 @@
 
 
 #include "PrvPlugin.h"
+#include "PrvGroundProbe.h"
+#include "PrvSubstepForces.h"
+#include "PrvSuspensionKernel.h"
 #include "PrvVehicleDustEffect.h"
+#include "PrvVehicleSubsystem.h"
 #include "AI/Navigation/AvoidanceManager.h"
 #include "Components/SkinnedMeshComponent.h"
 #include "DrawDebugHelpers.h"
 #include "Engine/World.h"
 #include "Kismet/GameplayStatics.h"
 #include "Kismet/KismetMathLibrary.h"
-#include "Kismet/KismetSystemLibrary.h"
+#include "LandscapeHeightfieldCollisionComponent.h"
 #include "PhysicsEngine/PhysicsSettings.h"
 
 #include "Runtime/Launch/Resources/Version.h"
@@ -24,9 +28,21 @@ DECLARE_CYCLE_STAT(TEXT("Update Gear Box"), STAT_PrvMovementUpdateGearBox, STATG
 DECLARE_CYCLE_STAT(TEXT("Update Brake"), STAT_PrvMovementUpdateBrake, STATGROUP_MovementPhysics);
 DECLARE_CYCLE_STAT(TEXT("Update Engine"), STAT_PrvMovementUpdateEngine, STATGROUP_MovementPhysics);
 DECLARE_CYCLE_STAT(TEXT("Update Suspension"), STAT_PrvMovementUpdateSuspension, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Probe Wheels"), STAT_PrvMovementProbeWheels, STATGROUP_MovementPhysics);
 DECLARE_CYCLE_STAT(TEXT("Update Suspension Visuals Only"), STAT_PrvMovementUpdateSuspensionVisualsOnly, STATGROUP_MovementPhysics);
 DECLARE_CYCLE_STAT(TEXT("Update Friction"), STAT_PrvMovementUpdateFriction, STATGROUP_MovementPhysics);
 DECLARE_CYCLE_STAT(TEXT("Update Wheel Effects"), STAT_PrvMovementUpdateWheelEffects, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Suspension Trace"), STAT_PrvMovementSuspensionTrace, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Suspension Traces"), STAT_PrvMovementSuspensionTraces, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Suspension Broadphase"), STAT_PrvMovementSuspensionBroadphase, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Suspension Broadphase Primitives"), STAT_PrvMovementSuspensionBroadphasePrimitives, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Suspension Track Profile Probes"), STAT_PrvMovementSuspensionTrackProfileProbes, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Suspension Baked Ground Probes"), STAT_PrvMovementSuspensionBakedGroundProbes, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Suspension Landscape Probes"), STAT_PrvMovementSuspensionLandscapeProbes, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Suspension Last Contact Hits"), STAT_PrvMovementSuspensionLastContactHits, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Suspension Last Contact Misses"), STAT_PrvMovementSuspensionLastContactMisses, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Suspension Probes Issued"), STAT_PrvMovementSuspensionProbesIssued, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Suspension Probes Skipped"), STAT_PrvMovementSuspensionProbesSkipped, STATGROUP_MovementPhysics);
 
 static int32 GPrvVehicleShowDustEffect = 1;
 static FAutoConsoleVariableRef CVarPrvVehicleShowDustEffect(
@@ -40,8 +56,175 @@ static FAutoConsoleVariableRef CVarPrvVehicleShowDustEffectForOwnerOnly(
 	GPrvVehicleShowDustEffectForOwnerOnly,
 	TEXT("Only owner can see its own wheels dust effect"));
 
+static int32 GPrvVehicleAsyncSuspensionTrace = 1;
+static FAutoConsoleVariableRef CVarPrvVehicleAsyncSuspensionTrace(
+	TEXT("PrvVehicle.AsyncSuspensionTrace"),
+	GPrvVehicleAsyncSuspensionTrace,
+	TEXT("Allows vehicles with bAsyncSuspensionTrace to batch suspension traces through vehicle subsystem (one frame latency)"));
+
+static int32 GPrvVehicleSuspensionBroadphase = 1;
+static FAutoConsoleVariableRef CVarPrvVehicleSuspensionBroadphase(
+	TEXT("PrvVehicle.SuspensionBroadphase"),
+	GPrvVehicleSuspensionBroadphase,
+	TEXT("Allows vehicles with bSuspensionBroadphase to probe wheels against primitives found by one overlap per vehicle"));
+
+static int32 GPrvVehicleLandscapeGround = 1;
+static FAutoConsoleVariableRef CVarPrvVehicleLandscapeGround(
+	TEXT("PrvVehicle.LandscapeGround"),
+	GPrvVehicleLandscapeGround,
+	TEXT("Allows vehicles with bLandscapeGround to sample landscape heightfield instead of scene queries"));
+
+static int32 GPrvVehicleBakedGround = 1;
+static FAutoConsoleVariableRef CVarPrvVehicleBakedGround(
+	TEXT("PrvVehicle.BakedGround"),
+	GPrvVehicleBakedGround,
+	TEXT("Allows vehicles with bBakedGround to use baked ground grid: 0 - never, 1 - dedicated server only, 2 - always"));
+
+static int32 GPrvVehicleTrackGroundProfile = 1;
+static FAutoConsoleVariableRef CVarPrvVehicleTrackGroundProfile(
+	TEXT("PrvVehicle.TrackGroundProfile"),
+	GPrvVehicleTrackGroundProfile,
+	TEXT("Allows tracked vehicles with bTrackGroundProfile to put road wheels on sampled track ground profile"));
+
+static int32 GPrvVehicleSuspensionContactReuse = 0;
+static FAutoConsoleVariableRef CVarPrvVehicleSuspensionContactReuse(
+	TEXT("PrvVehicle.SuspensionContactReuse"),
+	GPrvVehicleSuspensionContactReuse,
+	TEXT("Probe wheels against the last touched primitive first, world query is made only on miss or near primitive bounds edge"));
+
+static int32 GPrvVehicleLegacyCylinderTrace = 0;
+static FAutoConsoleVariableRef CVarPrvVehicleLegacyCylinderTrace(
+	TEXT("PrvVehicle.LegacyCylinderTrace"),
+	GPrvVehicleLegacyCylinderTrace,
+	TEXT("Probe cylindrical wheels with multi sphere sweep and hits filtering instead of single box sweep"));
+
+static int32 GPrvVehicleSuspensionCoherence = 1;
+static FAutoConsoleVariableRef CVarPrvVehicleSuspensionCoherence(
+	TEXT("PrvVehicle.SuspensionCoherence"),
+	GPrvVehicleSuspensionCoherence,
+	TEXT("Allows vehicles with bSuspensionCoherence to reuse wheel contacts while wheels stay in place"));
+
+static int32 GPrvVehicleVisualsOnlyProbeDivisor = 0;
+static FAutoConsoleVariableRef CVarPrvVehicleVisualsOnlyProbeDivisor(
+	TEXT("PrvVehicle.VisualsOnlyProbeDivisor"),
+	GPrvVehicleVisualsOnlyProbeDivisor,
+	TEXT("Overrides VisualsOnlyProbeDivisor of all vehicles when above zero (1 = probe all proxy wheels every frame)"));
+
+static int32 GPrvVehicleSimdSuspension = 1;
+static FAutoConsoleVariableRef CVarPrvVehicleSimdSuspension(
+	TEXT("PrvVehicle.SimdSuspension"),
+	GPrvVehicleSimdSuspension,
+	TEXT("Evaluates suspension spring-damper of four wheels per instruction (0 = scalar reference)"));
+
+static int32 GPrvVehicleValidateSimdSuspension = 0;
+static FAutoConsoleVariableRef CVarPrvVehicleValidateSimdSuspension(
+	TEXT("PrvVehicle.ValidateSimdSuspension"),
+	GPrvVehicleValidateSimdSuspension,
+	TEXT("Compares vectorized suspension spring-damper with scalar reference each tick and logs mismatches"));
+
+static int32 GPrvVehicleImplicitSuspension = 1;
+static FAutoConsoleVariableRef CVarPrvVehicleImplicitSuspension(
+	TEXT("PrvVehicle.ImplicitSuspension"),
+	GPrvVehicleImplicitSuspension,
+	TEXT("Allows vehicles with bImplicitSuspension to integrate spring-damper implicitly"));
+
+static int32 GPrvVehiclePhysicsSubstepForces = 1;
+static FAutoConsoleVariableRef CVarPrvVehiclePhysicsSubstepForces(
+	TEXT("PrvVehicle.PhysicsSubstepForces"),
+	GPrvVehiclePhysicsSubstepForces,
+	TEXT("Allows vehicles with bPhysicsSubstepForces to add suspension, friction and drive forces on physics substeps"));
+
+static int32 GPrvVehicleDampingCorrectionTables = 1;
+static FAutoConsoleVariableRef CVarPrvVehicleDampingCorrectionTables(
+	TEXT("PrvVehicle.DampingCorrectionTables"),
+	GPrvVehicleDampingCorrectionTables,
+	TEXT("Takes suspension damping correction from precomputed tables instead of per wheel closed form (bDebugDampingCorrection always uses closed form)"));
+
+static int32 GPrvVehicleValidateDampingCorrectionTables = 0;
+static FAutoConsoleVariableRef CVarPrvVehicleValidateDampingCorrectionTables(
+	TEXT("PrvVehicle.ValidateDampingCorrectionTables"),
+	GPrvVehicleValidateDampingCorrectionTables,
+	TEXT("Compares damping correction tables with closed form each tick and logs mismatches"));
+
+static int32 GPrvVehicleBakedCurves = 1;
+static FAutoConsoleVariableRef CVarPrvVehicleBakedCurves(
+	TEXT("PrvVehicle.BakedCurves"),
+	GPrvVehicleBakedCurves,
+	TEXT("Evaluates vehicle curves from baked lookup tables instead of source curves"));
+
+static float GPrvVehicleCurveTableMaxError = 0.01f;
+static FAutoConsoleVariableRef CVarPrvVehicleCurveTableMaxError(
+	TEXT("PrvVehicle.CurveTableMaxError"),
+	GPrvVehicleCurveTableMaxError,
+	TEXT("Baked curve error (relative to curve value range) to warn about on bake"));
+
+static int32 GPrvVehicleFixedStepSimulation = 1;
+static FAutoConsoleVariableRef CVarPrvVehicleFixedStepSimulation(
+	TEXT("PrvVehicle.FixedStepSimulation"),
+	GPrvVehicleFixedStepSimulation,
+	TEXT("Allows vehicles with bFixedStepSimulation to simulate in fixed steps"));
+
+static int32 GPrvVehicleMultiRateStages = 1;
+static FAutoConsoleVariableRef CVarPrvVehicleMultiRateStages(
+	TEXT("PrvVehicle.MultiRateStages"),
+	GPrvVehicleMultiRateStages,
+	TEXT("Runs drivetrain and control stages at their own rates (0 runs all stages on every step)"));
+
+static float GPrvVehicleStageRateSteering = -1.f;
+static FAutoConsoleVariableRef CVarPrvVehicleStageRateSteering(
+	TEXT("PrvVehicle.StageRate.Steering"),
+	GPrvVehicleStageRateSteering,
+	TEXT("Overrides steering stage rate of all vehicles [Hz] (0 every step, negative uses vehicle setting)"));
+
+static float GPrvVehicleStageRateThrottle = -1.f;
+static FAutoConsoleVariableRef CVarPrvVehicleStageRateThrottle(
+	TEXT("PrvVehicle.StageRate.Throttle"),
+	GPrvVehicleStageRateThrottle,
+	TEXT("Overrides throttle stage rate of all vehicles [Hz] (0 every step, negative uses vehicle setting)"));
+
+static float GPrvVehicleStageRateGearBox = -1.f;
+static FAutoConsoleVariableRef CVarPrvVehicleStageRateGearBox(
+	TEXT("PrvVehicle.StageRate.GearBox"),
+	GPrvVehicleStageRateGearBox,
+	TEXT("Overrides gear box stage rate of all vehicles [Hz] (0 every step, negative uses vehicle setting)"));
+
+static float GPrvVehicleStageRateBrake = -1.f;
+static FAutoConsoleVariableRef CVarPrvVehicleStageRateBrake(
+	TEXT("PrvVehicle.StageRate.Brake"),
+	GPrvVehicleStageRateBrake,
+	TEXT("Overrides brake stage rate of all vehicles [Hz] (0 every step, negative uses vehicle setting)"));
+
+static float GPrvVehicleStageRateEngine = -1.f;
+static FAutoConsoleVariableRef CVarPrvVehicleStageRateEngine(
+	TEXT("PrvVehicle.StageRate.Engine"),
+	GPrvVehicleStageRateEngine,
+	TEXT("Overrides engine stage rate of all vehicles [Hz] (0 every step, negative uses vehicle setting)"));
+
+static float GPrvVehicleStageRateSound = -1.f;
+static FAutoConsoleVariableRef CVarPrvVehicleStageRateSound(
+	TEXT("PrvVehicle.StageRate.Sound"),
+	GPrvVehicleStageRateSound,
+	TEXT("Overrides sound stage rate of all vehicles [Hz] (0 every step, negative uses vehicle setting)"));
+
+static int32 GPrvVehicleDeferredPhysicsCommands = 1;
+static FAutoConsoleVariableRef CVarPrvVehicleDeferredPhysicsCommands(
+	TEXT("PrvVehicle.DeferredPhysicsCommands"),
+	GPrvVehicleDeferredPhysicsCommands,
+	TEXT("Allows vehicles with bDeferredPhysicsCommands to apply forces through vehicle subsystem batch"));
+
+
+
+
+/** Evaluate curve through its baked table if there is one */
+static float PrvEvalCurve(FRuntimeFloatCurve& Curve, const TSharedPtr<const FPrvCurveTable>& Table, float Time)
+{
+	if (GPrvVehicleBakedCurves != 0 && Table.IsValid())
+	{
+		return Table->Eval(Time);
+	}
 
-
+	return Curve.GetRichCurve()->Eval(Time);
+}
 
 float FPIDController::CalcNewInput(float Error, float Position)
 {
@@ -84,6 +267,8 @@ LoadInterpSpeed=1.0f;
 	bIsMovementEnabled = true;
 	LastUserSteeringInput = 0;
 	bShouldAnimateWheels = true;
+	VisualsOnlyProbeDivisor = 1;
+	VisualsOnlyProbePhase = 0;
 	bFakeAutonomousProxy = false;
 
 	SprocketMass = 65.f;
@@ -92,6 +277,26 @@ LoadInterpSpeed=1.0f;
 	SleepLinearVelocity = 5.f;
 	SleepAngularVelocity = 5.f;
 	SleepDelay = 2.f;
+	bDeferredPhysicsCommands = false;
+	bFixedStepSimulation = false;
+	bPhysicsSubstepForces = false;
+	FixedStepRate = 60.f;
+	MaxFixedSteps = 4;
+	FixedStepAccumulator = 0.f;
+	ReactionForceScale = 1.f;
+	FixedStepForce = FVector::ZeroVector;
+	FixedStepTorque = FVector::ZeroVector;
+	FixedStepAngularVelocityInDegrees = FVector::ZeroVector;
+	bFixedStepSetAngularVelocity = false;
+	bSubstepForcesQueued = false;
+	bBatchedTick = false;
+	bDeferGameThreadEvents = false;
+	bGearShiftTimerPending = false;
+	PendingGearShiftFromGear = 0;
+	for (float& ElapsedTime : StageElapsedTime)
+	{
+		ElapsedTime = 0.f;
+	}
 	bDisableGravityForSimulated = true;
 
 	ForceSurfaceType = EPhysicalSurface::SurfaceType_Default;
@@ -106,6 +311,7 @@ LoadInterpSpeed=1.0f;
 	TurnRateModAngularSpeed = 0.f;
 
 	bUseSteeringCurve = false;
+	SteeringCurveResolution = 256;
 	FRichCurve* SteeringCurveData = SteeringCurve.GetRichCurve();
 	SteeringCurveData->AddKey(0.f, SteeringAngularSpeed);
 	SteeringCurveData->AddKey(2000.f, SteeringAngularSpeed); // 72 Km/h
@@ -125,8 +331,25 @@ LoadInterpSpeed=1.0f;
 	bCustomDampingCorrection = true;
 	DampingCorrectionFactor = 1.f;
 	bAdaptiveDampingCorrection = true;
+	bImplicitSuspension = false;
 	bNotifyRigidBodyCollision = true;
 	bTraceComplex = true;
+	bAsyncSuspensionTrace = false;
+	SuspensionTraceChannel = ECC_Visibility;
+	CachedSuspensionTraceTypeQuery = TraceTypeQuery_MAX;
+	bSuspensionBroadphase = false;
+	bBroadphaseActive = false;
+	bBroadphaseLandscapeOnly = false;
+	DampingCorrectionTablesMass = 0.f;
+	DampingCorrectionTablesFactor = 0.f;
+	bLandscapeGround = false;
+	bBakedGround = false;
+	bTrackGroundProfile = false;
+	TrackProfileSamples = 4;
+	BroadphaseGroundGrid = nullptr;
+	bSuspensionCoherence = false;
+	SuspensionCoherenceDistance = 0.5f;
+	SuspensionCoherenceFrames = 10;
 
 	GearSetup.AddDefaulted(1); // Add at least one gear should exist
 	bAutoGear = true;
@@ -151,6 +374,7 @@ LoadInterpSpeed=1.0f;
 	SteeringBrakeFactor = 1.f;
 	AutoBrakeActivationDelta = 2.f;
 
+	AutoBrakeUpRatioResolution = 256;
 	FRichCurve* AutoBrakeCurveData = AutoBrakeUpRatio.GetRichCurve();
 	AutoBrakeCurveData->AddKey(0.f, 30.f);
 	AutoBrakeCurveData->AddKey(1000.f, 30.f);
@@ -169,6 +393,7 @@ LoadInterpSpeed=1.0f;
 	bStartExtraPowerMovingLast = false;
 
 	bLimitMaxSpeed = false;
+	MaxSpeedCurveResolution = 256;
 	FRichCurve* MaxSpeedCurveData = MaxSpeedCurve.GetRichCurve();
 	MaxSpeedCurveData->AddKey(0.f, 2000.f); // 72 Km/h
 
@@ -183,6 +408,7 @@ LoadInterpSpeed=1.0f;
 	DropFactor = 5.f;
 
 	// Init basic torque curve
+	EngineTorqueCurveResolution = 4096;
 	FRichCurve* TorqueCurveData = EngineTorqueCurve.GetRichCurve();
 	TorqueCurveData->AddKey(0.f, 800.f);
 	TorqueCurveData->AddKey(1400.f, 850.f);
@@ -255,6 +481,7 @@ bIsPlayerRVO=false;
 	
 	bEnableAntiRollover = false;
 	AntiRolloverValueThreshold = 1.f;
+	AntiRolloverForceCurveResolution = 256;
 	FRichCurve* AntiRolloverForceCurveData = AntiRolloverForceCurve.GetRichCurve();
 	AntiRolloverForceCurveData->AddKey(0.f, 1000000000.0f);
 	AntiRolloverForceCurveData->AddKey(1.f, 20000000000.0f);
@@ -275,7 +502,11 @@ void UPrvVehicleMovementComponent::InitializeComponent()
 	CalculateMOI();
 	InitSuspension();
 	InitGears();
+	InitSuspensionQueryParams();
+	UpdateCurveTables();
 
+	SubstepForces = MakeShared<FPrvSubstepForces, ESPMode::ThreadSafe>();
+	OnCalculateCustomPhysics.BindThreadSafeSP(SubstepForces.ToSharedRef(), &FPrvSubstepForces::Substep);
 	
 	// Cache RPM limits
 	FRichCurve* TorqueCurveData = EngineTorqueCurve.GetRichCurve();
@@ -286,12 +517,81 @@ void UPrvVehicleMovementComponent::InitializeComponent()
 	MaxEngineRPM = FMath::Max(0.f, MaxEngineRPM);
 }
 
+#if WITH_EDITOR
+void UPrvVehicleMovementComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// Curve editor doesn't report which curve was changed
+	if (HasBeenInitialized())
+	{
+		UpdateCurveTables();
+	}
+}
+#endif
+
+static void PrvBakeCurve(FRuntimeFloatCurve& Curve, int32 Resolution, TSharedPtr<const FPrvCurveTable>& OutTable, const TCHAR* CurveName, const UObject* Owner)
+{
+	OutTable = FPrvCurveTable::FindOrBake(*Curve.GetRichCurve(), Resolution);
+
+	if (OutTable.IsValid() == false)
+	{
+		UE_LOG(LogPrvVehicle, Log, TEXT("%s: %s has non-constant extrapolation and is evaluated without lookup table"), *GetNameSafe(Owner), CurveName);
+		return;
+	}
+
+	const float RelativeError = OutTable->MaxError / FMath::Max(OutTable->ValueRange, SMALL_NUMBER);
+	if (RelativeError > GPrvVehicleCurveTableMaxError)
+	{
+		UE_LOG(LogPrvVehicle, Warning, TEXT("%s: %s baked with %d steps differs from source curve by %f (%.2f%% of value range), increase its resolution"),
+			*GetNameSafe(Owner), CurveName, OutTable->Values.Num() - 1, OutTable->MaxError, RelativeError * 100.f);
+	}
+	else
+	{
+		UE_LOG(LogPrvVehicle, Verbose, TEXT("%s: %s baked with %d steps, max error %f"), *GetNameSafe(Owner), CurveName, OutTable->Values.Num() - 1, OutTable->MaxError);
+	}
+}
+
+void UPrvVehicleMovementComponent::UpdateCurveTables()
+{
+	PrvBakeCurve(EngineTorqueCurve, EngineTorqueCurveResolution, EngineTorqueCurveTable, TEXT("EngineTorqueCurve"), this);
+	PrvBakeCurve(MaxSpeedCurve, MaxSpeedCurveResolution, MaxSpeedCurveTable, TEXT("MaxSpeedCurve"), this);
+	PrvBakeCurve(SteeringCurve, SteeringCurveResolution, SteeringCurveTable, TEXT("SteeringCurve"), this);
+	PrvBakeCurve(AutoBrakeUpRatio, AutoBrakeUpRatioResolution, AutoBrakeUpRatioTable, TEXT("AutoBrakeUpRatio"), this);
+	PrvBakeCurve(AntiRolloverForceCurve, AntiRolloverForceCurveResolution, AntiRolloverForceCurveTable, TEXT("AntiRolloverForceCurve"), this);
+}
+
 void UPrvVehicleMovementComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
+	PRV_CYCLE_COUNTER(STAT_PrvMovementTickComponent);
 
-	
+	// Vehicle subsystem ticks all vehicles together
+	if (bBatchedTick)
+	{
+		return;
+	}
 
-	
+	FPrvBodySnapshot Body;
+	if (!BeginTick(DeltaTime, TickType, ThisTickFunction, Body))
+	{
+		return;
+	}
+
+	const EPrvTickSimulation Simulation = BeginSimulation(DeltaTime, Body);
+	if (Simulation == EPrvTickSimulation::Step)
+	{
+		SimulateStep(DeltaTime, Body);
+	}
+	else if (Simulation == EPrvTickSimulation::FixedSteps)
+	{
+		SimulateFixedSteps(DeltaTime, Body);
+	}
+
+	EndTick(DeltaTime, Body, Simulation);
+}
+
+bool UPrvVehicleMovementComponent::BeginTick(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction, FPrvBodySnapshot& OutBody)
+{
 		if (AvoidanceLockTimer > 0.0f)
 		{
 			AvoidanceLockTimer -= DeltaTime;
@@ -310,8 +610,6 @@ void UPrvVehicleMovementComponent::TickComponent(float DeltaTime, enum ELevelTic
 		SetSteeringInput(CalcSteeringInput());
 	}
 	
-	PRV_CYCLE_COUNTER(STAT_PrvMovementTickComponent);
-
 	// Notify server about player input
 	APawn* MyOwner = UpdatedMesh ? Cast<APawn>(UpdatedMesh->GetOwner()) : nullptr;
 	if (MyOwner && MyOwner->IsLocallyControlled())
@@ -333,88 +631,102 @@ void UPrvVehicleMovementComponent::TickComponent(float DeltaTime, enum ELevelTic
 	// Check that mesh exists
 	if (!UpdatedMesh)
 	{
-		return;
+		return false;
 	}
 
+	// Read rigid body state once, all stages below work with the snapshot
+	CaptureBodySnapshot(OutBody);
+
 	// Reset sleeping state each time we have any input
 	if (HasInput())
 	{
 		ResetSleep();
 	}
+
+	return true;
+}
+
+EPrvTickSimulation UPrvVehicleMovementComponent::BeginSimulation(float DeltaTime, const FPrvBodySnapshot& Body)
+{
 	// Check we're not sleeping (don't update physics state while sleeping)
-	if (!IsSleeping(DeltaTime))
+	if (IsSleeping(DeltaTime, Body))
+	{
+		return EPrvTickSimulation::None;
+	}
+
+	// Perform full simulation only on server and for local owner
+	if (Body.bAddForce)
 	{
-		// Perform full simulation only on server and for local owner
-		if (ShouldAddForce())
+		if (UseFixedStepSimulation())
 		{
+			return EPrvTickSimulation::FixedSteps;
+		}
 
-			
-			// Suspension
-			UpdateSuspension(DeltaTime);
-		
-			UpdateFriction(DeltaTime);
+		ForceAccumulator.Reset(Body.CenterOfMass);
+		return EPrvTickSimulation::Step;
+	}
 
-			// Engine
-			UpdateSteering(DeltaTime);
-			UpdateThrottle(DeltaTime);
+	// Check that wheels should be animated anyway
+	UpdateSuspensionVisualsOnly(DeltaTime, Body);
 
-			// Control
-			UpdateGearBox();
-			UpdateBrake(DeltaTime);
+	// Disable gravity for ROLE_SimulatedProxy or fake autonomous ones
+	if (bDisableGravityForSimulated && UpdatedMesh->IsGravityEnabled())
+	{
+		UpdatedMesh->SetEnableGravity(false);
+	}
 
-			// Movement
-			UpdateTracksVelocity(DeltaTime);
-			UpdateHullVelocity(DeltaTime);
-			UpdateEngineStartExtraPower(DeltaTime);
-			UpdateEngine();
-			UpdateDriveForce();
+	// Check if we are in the process of body's state correction
+	if (bCorrectionInProgress && GetWorld()->GetTimeSeconds() >= CorrectionEndTime)
+	{
+		// Time has come
+		// Set the body into it's meant position
 
-			// Additional damping
-			UpdateLinearVelocity(DeltaTime);
-			UpdateAngularVelocity(DeltaTime);
-			UpdateSound(DeltaTime);
+		bCorrectionInProgress = false;
 
-			if (bEnableAntiRollover)
-			{
-				UpdateAntiRollover(DeltaTime);
-			}
+		FVector DeltaPos(FVector::ZeroVector);
+		ErrorCorrectionData.LinearDeltaThresholdSq /= 2.f;
+		ErrorCorrectionData.AngularDeltaThreshold /= 2.f;
+		ErrorCorrectionData.LinearRecipFixTime *= 2.f;
+		ErrorCorrectionData.AngularRecipFixTime *= 2.f;
+if(bShowDebug)
+		UE_LOG(LogPrvVehicle, Verbose, TEXT("Force correct body position, LinearRecipFixTime=%.2f"), ErrorCorrectionData.LinearRecipFixTime);
 
-			UpdateReplicatedCosmeticData();
-		}
-		else
-		{
-			// Check that wheels should be animated anyway
-			UpdateSuspensionVisualsOnly(DeltaTime);
+		ApplyRigidBodyState(CorrectionEndState, ErrorCorrectionData, DeltaPos);
+	}
 
-			// Disable gravity for ROLE_SimulatedProxy or fake autonomous ones
-			if (bDisableGravityForSimulated && UpdatedMesh->IsGravityEnabled())
-			{
-				UpdatedMesh->SetEnableGravity(false);
-			}
+	return EPrvTickSimulation::None;
+}
 
-			// Check if we are in the process of body's state correction
-			if (bCorrectionInProgress && GetWorld()->GetTimeSeconds() >= CorrectionEndTime)
-			{
-				// Time has come
-				// Set the body into it's meant position
+void UPrvVehicleMovementComponent::EndTick(float DeltaTime, const FPrvBodySnapshot& Body, EPrvTickSimulation Simulation)
+{
+	if (Simulation == EPrvTickSimulation::Step)
+	{
+		// Substeps get drivetrain state of this tick
+		if (UsePhysicsSubstepForces())
+		{
+			QueuePhysicsSubstepForces(Body);
+		}
 
-				bCorrectionInProgress = false;
+		FlushForceAccumulator();
+	}
 
-				FVector DeltaPos(FVector::ZeroVector);
-				ErrorCorrectionData.LinearDeltaThresholdSq /= 2.f;
-				ErrorCorrectionData.AngularDeltaThreshold /= 2.f;
-				ErrorCorrectionData.LinearRecipFixTime *= 2.f;
-				ErrorCorrectionData.AngularRecipFixTime *= 2.f;
-if(bShowDebug)
-				UE_LOG(LogPrvVehicle, Verbose, TEXT("Force correct body position, LinearRecipFixTime=%.2f"), ErrorCorrectionData.LinearRecipFixTime);
+	// Results of paused substeps are stale
+	if (bSubstepForcesQueued && (Simulation != EPrvTickSimulation::Step || !UsePhysicsSubstepForces()))
+	{
+		SubstepForces->ResetOutput();
+		bSubstepForcesQueued = false;
+	}
 
-				ApplyRigidBodyState(CorrectionEndState, ErrorCorrectionData, DeltaPos);
-			}
-		}
+	if (Simulation != EPrvTickSimulation::None)
+	{
+		UpdateReplicatedCosmeticData();
 	}
 
-	
-	AnimateWheels(DeltaTime);
+	// Fixed steps animate wheels themselves
+	if (Simulation != EPrvTickSimulation::FixedSteps)
+	{
+		AnimateWheels(DeltaTime);
+	}
 
 	// Update dust VFX
 	if (!IsRunningDedicatedServer())
@@ -427,10 +739,6 @@ if(bShowDebug)
 	{
 		DrawDebugLines();
 	}
-	/*avoidance*/
-	
-	
-	
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -518,6 +826,7 @@ void UPrvVehicleMovementComponent::InitSuspension()
 		SuspState.SuspensionInfo = SuspInfo;
 		SuspState.PreviousLength = SuspInfo.Length;
 		SuspState.VisualLength = DefaultLength;
+		SuspState.SampledLength = SuspInfo.Length;
 
 		if (SuspInfo.bSpawnDust)
 		{
@@ -526,6 +835,58 @@ void UPrvVehicleMovementComponent::InitSuspension()
 
 		SuspensionData.Add(SuspState);
 	}
+
+	InitSuspensionSimData();
+}
+
+void UPrvVehicleMovementComponent::InitSuspensionSimData()
+{
+	SuspensionSimData.SetNum(SuspensionData.Num());
+
+	for (int32 WheelIdx = 0; WheelIdx < SuspensionData.Num(); ++WheelIdx)
+	{
+		const FSuspensionState& SuspState = SuspensionData[WheelIdx];
+		const FSuspensionInfo& SuspInfo = SuspState.SuspensionInfo;
+
+		SuspensionSimData.PreviousLength[WheelIdx] = SuspState.PreviousLength;
+		SuspensionSimData.ContactLength[WheelIdx] = SuspState.PreviousLength;
+		SuspensionSimData.ContactNormal[WheelIdx] = FVector::UpVector;
+		SuspensionSimData.ProbeDirection[WheelIdx] = FVector::UpVector;
+	}
+
+	UpdateSuspensionSimConfig();
+
+	// Wheels config has changed
+	DampingCorrectionTables.Reset();
+}
+
+void UPrvVehicleMovementComponent::UpdateSuspensionSimConfig()
+{
+	FPrvSuspensionSimData& Sim = SuspensionSimData;
+	bool bDampingChanged = false;
+
+	for (int32 WheelIdx = 0; WheelIdx < Sim.Num(); ++WheelIdx)
+	{
+		const FSuspensionInfo& SuspInfo = SuspensionData[WheelIdx].SuspensionInfo;
+
+		const float Stiffness = SuspInfo.Stiffness * StiffnessFactor;
+		const float CompressionDamping = SuspInfo.CompressionDamping * CompressionDampingFactor;
+		const float DecompressionDamping = SuspInfo.DecompressionDamping * DecompressionDampingFactor;
+
+		bDampingChanged |= (Sim.Stiffness[WheelIdx] != Stiffness || Sim.CompressionDamping[WheelIdx] != CompressionDamping || Sim.DecompressionDamping[WheelIdx] != DecompressionDamping);
+
+		Sim.Length[WheelIdx] = SuspInfo.Length;
+		Sim.InvLength[WheelIdx] = (SuspInfo.Length > SMALL_NUMBER) ? (1.f / SuspInfo.Length) : 0.f;
+		Sim.Stiffness[WheelIdx] = Stiffness;
+		Sim.CompressionDamping[WheelIdx] = CompressionDamping;
+		Sim.DecompressionDamping[WheelIdx] = DecompressionDamping;
+	}
+
+	// Tables are keyed by stiffness and damping
+	if (bDampingChanged)
+	{
+		DampingCorrectionTables.Reset();
+	}
 }
 
 void UPrvVehicleMovementComponent::InitGears()
@@ -547,6 +908,18 @@ void UPrvVehicleMovementComponent::InitGears()
 	UE_LOG(LogPrvVehicle, Warning, TEXT("Neutral gear: %d"), NeutralGear);
 }
 
+void UPrvVehicleMovementComponent::InitSuspensionQueryParams()
+{
+	SuspensionTraceChannel = UEngineTypes::ConvertToCollisionChannel(SuspensionTraceTypeQuery);
+	CachedSuspensionTraceTypeQuery = SuspensionTraceTypeQuery;
+
+	SuspensionQueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(PrvSuspensionTrace), bTraceComplex, GetOwner());
+	SuspensionQueryParams.bReturnPhysicalMaterial = true;
+	SuspensionQueryParams.bReturnFaceIndex = false;
+
+	SuspensionResponseParams = FCollisionResponseParams::DefaultResponseParam;
+}
+
 void UPrvVehicleMovementComponent::CalculateMOI()
 {
 	if (!UpdatedMesh)
@@ -570,7 +943,339 @@ void UPrvVehicleMovementComponent::CalculateMOI()
 //////////////////////////////////////////////////////////////////////////
 // Physics simulation
 
-bool UPrvVehicleMovementComponent::IsSleeping(float DeltaTime)
+void UPrvVehicleMovementComponent::SimulateStep(float DeltaTime, const FPrvBodySnapshot& Body)
+{
+	// Suspension
+	ProbeWheels(Body);
+	UpdateSuspension(DeltaTime, Body);
+
+	UpdateFriction(DeltaTime, Body);
+
+	SimulateDrivetrain(DeltaTime, Body);
+}
+
+void UPrvVehicleMovementComponent::SimulateDrivetrain(float DeltaTime, const FPrvBodySnapshot& Body)
+{
+	// Slow stages keep their outputs (torque transfer, brake ratio, drive torque) between updates
+	float StageDeltaTime = 0.f;
+
+	// Engine
+	if (ShouldUpdateStage(EPrvSimulationStage::Steering, DeltaTime, StageDeltaTime))
+	{
+		UpdateSteering(StageDeltaTime, Body);
+	}
+
+	if (ShouldUpdateStage(EPrvSimulationStage::Throttle, DeltaTime, StageDeltaTime))
+	{
+		UpdateThrottle(StageDeltaTime, Body);
+	}
+
+	// Control
+	if (ShouldUpdateStage(EPrvSimulationStage::GearBox, DeltaTime, StageDeltaTime))
+	{
+		UpdateGearBox(Body);
+	}
+
+	if (ShouldUpdateStage(EPrvSimulationStage::Brake, DeltaTime, StageDeltaTime))
+	{
+		UpdateBrake(StageDeltaTime, Body);
+	}
+
+	// Movement
+	UpdateTracksVelocity(DeltaTime, Body);
+	UpdateHullVelocity(DeltaTime);
+
+	if (ShouldUpdateStage(EPrvSimulationStage::Engine, DeltaTime, StageDeltaTime))
+	{
+		UpdateEngineStartExtraPower(StageDeltaTime, Body);
+		UpdateEngine(Body);
+	}
+
+	UpdateDriveForce(Body);
+
+	// Additional damping
+	UpdateLinearVelocity(DeltaTime);
+	UpdateAngularVelocity(DeltaTime);
+
+	if (ShouldUpdateStage(EPrvSimulationStage::Sound, DeltaTime, StageDeltaTime))
+	{
+		UpdateSound(StageDeltaTime);
+	}
+
+	if (bEnableAntiRollover)
+	{
+		UpdateAntiRollover(DeltaTime, Body);
+	}
+}
+
+void UPrvVehicleMovementComponent::SimulateFixedSteps(float DeltaTime, const FPrvBodySnapshot& Body)
+{
+	const float StepTime = 1.f / FMath::Max(FixedStepRate, 1.f);
+	const int32 WheelsNum = SuspensionData.Num();
+
+	// Simulation continues from the last step, not from interpolated visuals
+	if (FixedStepWheelVisuals.Num() != WheelsNum)
+	{
+		FixedStepWheelVisuals.SetNum(WheelsNum);
+		for (int32 WheelIdx = 0; WheelIdx < WheelsNum; ++WheelIdx)
+		{
+			FPrvFixedStepWheelVisuals& Visuals = FixedStepWheelVisuals[WheelIdx];
+			Visuals.PreviousVisualLength = Visuals.VisualLength = SuspensionData[WheelIdx].VisualLength;
+			Visuals.PreviousRotationAngle = Visuals.RotationAngle = SuspensionData[WheelIdx].RotationAngle;
+		}
+	}
+	else
+	{
+		for (int32 WheelIdx = 0; WheelIdx < WheelsNum; ++WheelIdx)
+		{
+			SuspensionData[WheelIdx].VisualLength = FixedStepWheelVisuals[WheelIdx].VisualLength;
+			SuspensionData[WheelIdx].RotationAngle = FixedStepWheelVisuals[WheelIdx].RotationAngle;
+		}
+	}
+
+	FixedStepAccumulator += DeltaTime;
+
+	int32 StepsNum = FMath::FloorToInt(FixedStepAccumulator / StepTime);
+	if (StepsNum > MaxFixedSteps)
+	{
+		// Drop the time we can't afford to simulate
+		StepsNum = FMath::Max(1, MaxFixedSteps);
+		FixedStepAccumulator = StepsNum * StepTime + FMath::Fmod(FixedStepAccumulator, StepTime);
+	}
+
+	FixedStepAccumulator = FMath::Max(0.f, FixedStepAccumulator - StepsNum * StepTime);
+
+	ForceAccumulator.Reset(Body.CenterOfMass);
+
+	if (StepsNum > 0)
+	{
+		const float InvStepsNum = 1.f / StepsNum;
+		ReactionForceScale = InvStepsNum;
+
+		// Physics moves the body once per frame, so further steps see its predicted pose
+		FPrvBodySnapshot StepBody = Body;
+
+		for (int32 StepIdx = 0; StepIdx < StepsNum; ++StepIdx)
+		{
+			for (int32 WheelIdx = 0; WheelIdx < WheelsNum; ++WheelIdx)
+			{
+				FixedStepWheelVisuals[WheelIdx].PreviousVisualLength = SuspensionData[WheelIdx].VisualLength;
+				FixedStepWheelVisuals[WheelIdx].PreviousRotationAngle = SuspensionData[WheelIdx].RotationAngle;
+			}
+
+			SimulateStep(StepTime, StepBody);
+			AnimateWheels(StepTime);
+
+			StepBody.Advance(StepTime);
+		}
+
+		for (int32 WheelIdx = 0; WheelIdx < WheelsNum; ++WheelIdx)
+		{
+			FixedStepWheelVisuals[WheelIdx].VisualLength = SuspensionData[WheelIdx].VisualLength;
+			FixedStepWheelVisuals[WheelIdx].RotationAngle = SuspensionData[WheelIdx].RotationAngle;
+		}
+
+		ReactionForceScale = 1.f;
+
+		// Physics integrates forces over the whole frame, so steps contribute their average
+		ForceAccumulator.Force *= InvStepsNum;
+		ForceAccumulator.Torque *= InvStepsNum;
+
+		FixedStepForce = ForceAccumulator.Force;
+		FixedStepTorque = ForceAccumulator.Torque;
+		FixedStepAngularVelocityInDegrees = ForceAccumulator.AngularVelocityInDegrees;
+		bFixedStepSetAngularVelocity = ForceAccumulator.bSetAngularVelocity;
+	}
+	else
+	{
+		// Frame is shorter than the step: keep forces and steering of the last steps
+		ForceAccumulator.AddForce(FixedStepForce);
+		ForceAccumulator.AddTorqueInRadians(FixedStepTorque);
+
+		// Steering keeps overriding angular velocity, otherwise physics would turn the body freely until the next step
+		if (bFixedStepSetAngularVelocity)
+		{
+			ForceAccumulator.SetAngularVelocityInDegrees(FixedStepAngularVelocityInDegrees);
+		}
+	}
+
+	FlushForceAccumulator();
+
+	// Render wheels between the last two steps
+	const float Alpha = FMath::Clamp(FixedStepAccumulator / StepTime, 0.f, 1.f);
+	for (int32 WheelIdx = 0; WheelIdx < WheelsNum; ++WheelIdx)
+	{
+		const FPrvFixedStepWheelVisuals& Visuals = FixedStepWheelVisuals[WheelIdx];
+		FSuspensionState& SuspState = SuspensionData[WheelIdx];
+
+		SuspState.VisualLength = FMath::Lerp(Visuals.PreviousVisualLength, Visuals.VisualLength, Alpha);
+		SuspState.RotationAngle = FRotator::NormalizeAxis(Visuals.PreviousRotationAngle + FRotator::NormalizeAxis(Visuals.RotationAngle - Visuals.PreviousRotationAngle) * Alpha);
+	}
+}
+
+bool UPrvVehicleMovementComponent::UseFixedStepSimulation() const
+{
+	return bFixedStepSimulation && (GPrvVehicleFixedStepSimulation != 0);
+}
+
+bool UPrvVehicleMovementComponent::UsePhysicsSubstepForces() const
+{
+	// Custom physics callbacks are made by physics substepping only
+	return bPhysicsSubstepForces && (GPrvVehiclePhysicsSubstepForces != 0) && UPhysicsSettings::Get()->bSubstepping && SubstepForces.IsValid() && !UseFixedStepSimulation();
+}
+
+bool UPrvVehicleMovementComponent::HasPhysicsSubstepOutput() const
+{
+	if (!UsePhysicsSubstepForces())
+	{
+		return false;
+	}
+
+	const FPrvSubstepOutput& Output = SubstepForces->GetOutput();
+	return Output.SubstepsNum > 0 && Output.Force.Num() == SuspensionData.Num();
+}
+
+void UPrvVehicleMovementComponent::QueuePhysicsSubstepForces(const FPrvBodySnapshot& Body)
+{
+	FBodyInstance* BodyInstance = UpdatedMesh->GetBodyInstance();
+	if (!BodyInstance)
+	{
+		return;
+	}
+
+	const FPrvSuspensionSimData& Sim = SuspensionSimData;
+	const bool bUseLineTrace = UseLineTrace();
+
+	// Input is kept between frames, so nothing is allocated while wheels number stays the same
+	FPrvSubstepInput& Input = SubstepForces->GetInput();
+	Input.ComponentToBody = Body.ComponentTransform.GetRelativeTransform(BodyInstance->GetUnrealWorldTransform());
+	Input.LocalDriveForce[0] = Body.ComponentTransform.InverseTransformVectorNoScale(LeftTrack.DriveForce);
+	Input.LocalDriveForce[1] = Body.ComponentTransform.InverseTransformVectorNoScale(RightTrack.DriveForce);
+	Input.TrackAngularSpeed[0] = LeftTrackEffectiveAngularSpeed;
+	Input.TrackAngularSpeed[1] = RightTrackEffectiveAngularSpeed;
+	Input.GravityZ = Body.GravityZ;
+	Input.SprocketRadius = SprocketRadius;
+	Input.WheelRotationRatio = (VisualCollisionRadius > SMALL_NUMBER) ? (SprocketRadius / VisualCollisionRadius) : 0.f;
+	Input.AntiSlipFactor = AntiSlipFactor;
+	Input.DriveForceMultiplier = CustomForceMuliplier;
+	Input.TransmissionRatio = GetCurrentGearInfo().Ratio * DifferentialRatio;
+	Input.MinEngineRPM = MinEngineRPM;
+	Input.MaxEngineRPM = MaxEngineRPM;
+	Input.bWheeledVehicle = bWheeledVehicle;
+	Input.bClampForce = bClampSuspensionForce;
+	Input.bImplicit = bImplicitSuspension && (GPrvVehicleImplicitSuspension != 0);
+	Input.bScaleDriveForce = bScaleForceToActiveFrictionPoints;
+	Input.bResetState = !bSubstepForcesQueued;
+
+	Input.Wheels.SetNum(SuspensionData.Num(), false);
+	for (int32 WheelIdx = 0; WheelIdx < SuspensionData.Num(); ++WheelIdx)
+	{
+		const FSuspensionState& SuspState = SuspensionData[WheelIdx];
+		FPrvSubstepWheelInput& Wheel = Input.Wheels[WheelIdx];
+
+		// Substeps move the probe with the component pose derived from the body
+		MakeWheelProbe(SuspState, FTransform::Identity, bUseLineTrace, Wheel.LocalProbe);
+
+		Wheel.bContact = (Sim.Contact[WheelIdx] != 0);
+		Wheel.ContactPoint = Sim.ContactLocation[WheelIdx];
+		Wheel.ContactNormal = Sim.ContactNormal[WheelIdx];
+
+		Wheel.Length = Sim.Length[WheelIdx];
+		Wheel.Stiffness = Sim.Stiffness[WheelIdx];
+		Wheel.CompressionDamping = Sim.CompressionDamping[WheelIdx];
+		Wheel.DecompressionDamping = Sim.DecompressionDamping[WheelIdx];
+		Wheel.PreviousLength = Sim.PreviousLength[WheelIdx];
+		Wheel.RotationAngle = SuspState.RotationAngle;
+
+		Wheel.bRightTrack = SuspState.SuspensionInfo.bRightTrack;
+		Wheel.bDriven = !bWheeledVehicle || SuspState.SuspensionInfo.bDrivingWheel;
+	}
+
+	SubstepForces->PublishInput();
+	bSubstepForcesQueued = true;
+
+	// Custom physics is consumed by the next physics frame, so it's added on each tick
+	BodyInstance->AddCustomPhysics(OnCalculateCustomPhysics);
+}
+
+bool UPrvVehicleMovementComponent::ShouldUpdateStage(EPrvSimulationStage Stage, float DeltaTime, float& OutStageDeltaTime)
+{
+	float& ElapsedTime = StageElapsedTime[(int32)Stage];
+	ElapsedTime += DeltaTime;
+
+	// Tolerance lets fixed steps hit the stage period exactly
+	const float StageRate = GetStageRate(Stage);
+	if (StageRate > 0.f && ElapsedTime < 1.f / StageRate - KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	OutStageDeltaTime = ElapsedTime;
+	ElapsedTime = 0.f;
+	return true;
+}
+
+float UPrvVehicleMovementComponent::GetStageRate(EPrvSimulationStage Stage) const
+{
+	if (GPrvVehicleMultiRateStages == 0)
+	{
+		return 0.f;
+	}
+
+	float VehicleRate = 0.f;
+	float OverrideRate = -1.f;
+
+	switch (Stage)
+	{
+	case EPrvSimulationStage::Steering:
+		VehicleRate = StageRates.Steering;
+		OverrideRate = GPrvVehicleStageRateSteering;
+		break;
+	case EPrvSimulationStage::Throttle:
+		VehicleRate = StageRates.Throttle;
+		OverrideRate = GPrvVehicleStageRateThrottle;
+		break;
+	case EPrvSimulationStage::GearBox:
+		VehicleRate = StageRates.GearBox;
+		OverrideRate = GPrvVehicleStageRateGearBox;
+		break;
+	case EPrvSimulationStage::Brake:
+		VehicleRate = StageRates.Brake;
+		OverrideRate = GPrvVehicleStageRateBrake;
+		break;
+	case EPrvSimulationStage::Engine:
+		VehicleRate = StageRates.Engine;
+		OverrideRate = GPrvVehicleStageRateEngine;
+		break;
+	case EPrvSimulationStage::Sound:
+		VehicleRate = StageRates.Sound;
+		OverrideRate = GPrvVehicleStageRateSound;
+		break;
+	default:
+		break;
+	}
+
+	return (OverrideRate >= 0.f) ? OverrideRate : VehicleRate;
+}
+
+void UPrvVehicleMovementComponent::CaptureBodySnapshot(FPrvBodySnapshot& OutBody) const
+{
+	OutBody.ComponentTransform = UpdatedMesh->GetComponentTransform();
+	OutBody.OwnerTransform = GetOwner() ? GetOwner()->GetTransform() : OutBody.ComponentTransform;
+
+	OutBody.ForwardVector = OutBody.ComponentTransform.GetUnitAxis(EAxis::X);
+	OutBody.RightVector = OutBody.ComponentTransform.GetUnitAxis(EAxis::Y);
+	OutBody.UpVector = OutBody.ComponentTransform.GetUnitAxis(EAxis::Z);
+
+	OutBody.LinearVelocity = UpdatedMesh->GetPhysicsLinearVelocity();
+	OutBody.AngularVelocityInDegrees = UpdatedMesh->GetPhysicsAngularVelocityInDegrees();
+	OutBody.CenterOfMass = UpdatedMesh->GetCenterOfMass();
+	OutBody.Mass = UpdatedMesh->GetMass();
+	OutBody.GravityZ = UPhysicsSettings::Get()->DefaultGravityZ;
+	OutBody.bAddForce = ShouldAddForce();
+}
+
+bool UPrvVehicleMovementComponent::IsSleeping(float DeltaTime, const FPrvBodySnapshot& Body)
 {
 	// Force sleeping if mesh isn't simulate physics
 	if (UpdatedMesh && !UpdatedMesh->IsSimulatingPhysics())
@@ -599,8 +1304,8 @@ bool UPrvVehicleMovementComponent::IsSleeping(float DeltaTime)
 	}
 
 	if (UpdatedMesh &&
-		UpdatedMesh->GetPhysicsLinearVelocity().SizeSquared() < SleepLinearVelocity &&
-		UpdatedMesh->GetPhysicsAngularVelocityInDegrees().SizeSquared() < SleepAngularVelocity)
+		Body.LinearVelocity.SizeSquared() < SleepLinearVelocity &&
+		Body.AngularVelocityInDegrees.SizeSquared() < SleepAngularVelocity)
 	{
 		if (!bIsSleeping)
 		{
@@ -633,7 +1338,7 @@ void UPrvVehicleMovementComponent::OnRep_IsSleeping()
 	}
 }
 
-void UPrvVehicleMovementComponent::UpdateSteering(float DeltaTime)
+void UPrvVehicleMovementComponent::UpdateSteering(float DeltaTime, const FPrvBodySnapshot& Body)
 {
 	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateSteering);
 
@@ -704,13 +1409,12 @@ void UPrvVehicleMovementComponent::UpdateSteering(float DeltaTime)
 		RightTrack.Input = -SteeringInput;
 	}
 
-	const float CurrentSpeed = UpdatedMesh->GetComponentVelocity().Size();
+	const float CurrentSpeed = Body.LinearVelocity.Size();
 
 	if (bUseSteeringCurve)
 	{
-		FRichCurve* SteeringCurveData = SteeringCurve.GetRichCurve();
-		const float SteeringCurveZeroPoint = FMath::Min(SteeringCurveData->Eval(0.f) + TurnRateModAngularSpeed, SteeringAngularSpeed);
-		const float SteeringCurvePoint = FMath::Min(SteeringCurveData->Eval(GetForwardSpeed()) + TurnRateModAngularSpeed, SteeringAngularSpeed);
+		const float SteeringCurveZeroPoint = FMath::Min(PrvEvalCurve(SteeringCurve, SteeringCurveTable, 0.f) + TurnRateModAngularSpeed, SteeringAngularSpeed);
+		const float SteeringCurvePoint = FMath::Min(PrvEvalCurve(SteeringCurve, SteeringCurveTable, Body.GetForwardSpeed()) + TurnRateModAngularSpeed, SteeringAngularSpeed);
 
 		if (bMaximizeZeroThrottleSteering && FMath::IsNearlyZero(RawThrottleInput))
 		{
@@ -752,7 +1456,7 @@ void UPrvVehicleMovementComponent::UpdateSteering(float DeltaTime)
 
 	if (bAngularVelocitySteering)
 	{
-		FVector LocalAngularVelocity = UpdatedMesh->GetComponentTransform().InverseTransformVectorNoScale(UpdatedMesh->GetPhysicsAngularVelocityInDegrees());
+		FVector LocalAngularVelocity = Body.ComponentTransform.InverseTransformVectorNoScale(Body.AngularVelocityInDegrees);
 
 		float TargetSteeringVelocity = EffectiveSteeringAngularSpeed;
 
@@ -771,8 +1475,8 @@ void UPrvVehicleMovementComponent::UpdateSteering(float DeltaTime)
 				const float TurnRadius = TransmissionLength / TargetSteeringVelocitySin;
 				if (FMath::IsNearlyZero(TurnRadius) == false)
 				{
-					const FVector NormalizedVelocity = UpdatedMesh->GetComponentVelocity().GetSafeNormal();
-					const float SpeedXProjection = GetForwardSpeed() * FMath::Abs(FVector::DotProduct(UpdatedMesh->GetForwardVector(), NormalizedVelocity));
+					const FVector NormalizedVelocity = Body.LinearVelocity.GetSafeNormal();
+					const float SpeedXProjection = Body.GetForwardSpeed() * FMath::Abs(FVector::DotProduct(Body.ForwardVector, NormalizedVelocity));
 					TargetSteeringVelocity = FMath::RadiansToDegrees(SpeedXProjection / TurnRadius);
 				}
 			}
@@ -782,11 +1486,11 @@ void UPrvVehicleMovementComponent::UpdateSteering(float DeltaTime)
 		{
 			const bool bShouldSet = bAutoBrakeSteering ? (FMath::Abs(LocalAngularVelocity.Z) < FMath::Abs(TargetSteeringVelocity)) : true;
 
-			if (ShouldAddForce() && bShouldSet && bFullSteeringFriction)
+			if (Body.bAddForce && bShouldSet && bFullSteeringFriction)
 			{
 				LocalAngularVelocity.Z = TargetSteeringVelocity;
-				EffectiveSteeringVelocity = UpdatedMesh->GetComponentTransform().TransformVectorNoScale(LocalAngularVelocity);
-				UpdatedMesh->SetPhysicsAngularVelocityInDegrees(EffectiveSteeringVelocity);
+				EffectiveSteeringVelocity = Body.ComponentTransform.TransformVectorNoScale(LocalAngularVelocity);
+				ForceAccumulator.SetAngularVelocityInDegrees(EffectiveSteeringVelocity);
 			}
 		}
 		else
@@ -809,7 +1513,7 @@ void UPrvVehicleMovementComponent::UpdateSteering(float DeltaTime)
 	}
 }
 
-void UPrvVehicleMovementComponent::UpdateThrottle(float DeltaTime)
+void UPrvVehicleMovementComponent::UpdateThrottle(float DeltaTime, const FPrvBodySnapshot& Body)
 {
 	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateThrottle);
 	
@@ -856,12 +1560,12 @@ void UPrvVehicleMovementComponent::UpdateThrottle(float DeltaTime)
 	if (bShowDebug)
 	{
 		// Torque transfer balance
-		DrawDebugString(GetWorld(), UpdatedMesh->GetComponentTransform().TransformPosition(FVector(0.f, -100.f, 0.f)), FString::SanitizeFloat(LeftTrack.TorqueTransfer), nullptr, FColor::White, 0.f);
-		DrawDebugString(GetWorld(), UpdatedMesh->GetComponentTransform().TransformPosition(FVector(0.f, 100.f, 0.f)), FString::SanitizeFloat(RightTrack.TorqueTransfer), nullptr, FColor::White, 0.f);
+		DrawDebugString(GetWorld(), Body.ComponentTransform.TransformPosition(FVector(0.f, -100.f, 0.f)), FString::SanitizeFloat(LeftTrack.TorqueTransfer), nullptr, FColor::White, 0.f);
+		DrawDebugString(GetWorld(), Body.ComponentTransform.TransformPosition(FVector(0.f, 100.f, 0.f)), FString::SanitizeFloat(RightTrack.TorqueTransfer), nullptr, FColor::White, 0.f);
 	}
 }
 
-void UPrvVehicleMovementComponent::UpdateGearBox()
+void UPrvVehicleMovementComponent::UpdateGearBox(const FPrvBodySnapshot& Body)
 {
 	if (bGearTimer)
 		return;
@@ -895,7 +1599,7 @@ void UPrvVehicleMovementComponent::UpdateGearBox()
 		
 		}
 	}
-	const bool bIsMovingForward = (FVector::DotProduct(UpdatedMesh->GetForwardVector(), UpdatedMesh->GetComponentVelocity()) >= 0.f);
+	const bool bIsMovingForward = (FVector::DotProduct(Body.ForwardVector, Body.LinearVelocity) >= 0.f);
 	const bool bHasAppropriateGear = ((RawThrottleInput <= 0.f) == bReverseGear);
 
 	
@@ -946,9 +1650,16 @@ void UPrvVehicleMovementComponent::ShiftGear(bool bShiftUp)
 		bPendingShiftUp = bShiftUp;
 		
 		bGearTimer = true;
-	
-		GetWorld()->GetTimerManager().SetTimer(GearChangeHandle, this, &UPrvVehicleMovementComponent::ShiftGearByTimer, fGearboxLatency/FMath::Sqrt(MSBoost), false);
-		GearChange.Broadcast(CurrentGear, bShiftUp);
+
+		if (bDeferGameThreadEvents)
+		{
+			bGearShiftTimerPending = true;
+			PendingGearShiftFromGear = CurrentGear;
+		}
+		else
+		{
+			StartGearShiftTimer(CurrentGear);
+		}
 	}
 	else
 	{
@@ -1012,6 +1723,21 @@ void UPrvVehicleMovementComponent::ShiftGear(bool bShiftUp)
 }
 
 
+void UPrvVehicleMovementComponent::StartGearShiftTimer(int32 FromGear)
+{
+	GetWorld()->GetTimerManager().SetTimer(GearChangeHandle, this, &UPrvVehicleMovementComponent::ShiftGearByTimer, fGearboxLatency/FMath::Sqrt(MSBoost), false);
+	GearChange.Broadcast(FromGear, bPendingShiftUp);
+}
+
+void UPrvVehicleMovementComponent::FlushDeferredEvents()
+{
+	if (bGearShiftTimerPending)
+	{
+		bGearShiftTimerPending = false;
+		StartGearShiftTimer(PendingGearShiftFromGear);
+	}
+}
+
 void UPrvVehicleMovementComponent::ShiftGearByTimer()
 {
 
@@ -1239,16 +1965,16 @@ float UPrvVehicleMovementComponent::GetMaxSpeed() const
 {return MaxSpeed;
 }
 
-void UPrvVehicleMovementComponent::UpdateBrake(float DeltaTime)
+void UPrvVehicleMovementComponent::UpdateBrake(float DeltaTime, const FPrvBodySnapshot& Body)
 {
 	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateBrake);
 
 	float BrakeInputIncremented = 0.f;
-	const bool bIsMovingForward = FVector::DotProduct(UpdatedMesh->GetForwardVector(), UpdatedMesh->GetComponentVelocity()) >= 0.f;
+	const bool bIsMovingForward = FVector::DotProduct(Body.ForwardVector, Body.LinearVelocity) >= 0.f;
 
 	if (bAutoBrake)
 	{
-		const float AutoBrakeCurveValue = AutoBrakeUpRatio.GetRichCurve()->Eval(GetForwardSpeed());
+		const float AutoBrakeCurveValue = PrvEvalCurve(AutoBrakeUpRatio, AutoBrakeUpRatioTable, Body.GetForwardSpeed());
 		BrakeInputIncremented = FMath::Clamp(BrakeInput + AutoBrakeCurveValue * DeltaTime, 0.f, AutoBrakeFactor);
 		const bool bHasThrottleInput = (FMath::IsNearlyZero(RawThrottleInput) == false);
 
@@ -1344,10 +2070,9 @@ void UPrvVehicleMovementComponent::UpdateBrake(float DeltaTime)
 		bLimitMaxSpeed &&
 		FMath::IsNearlyZero(EffectiveSteeringAngularSpeed) == false)
 	{
-		const float CurrentSpeed = UpdatedMesh->GetComponentVelocity().Size();
+		const float CurrentSpeed = Body.LinearVelocity.Size();
 
-		FRichCurve* MaxSpeedCurveData = MaxSpeedCurve.GetRichCurve();
-		const float MaxSpeedLimit = MaxSpeedCurveData->Eval(FMath::Abs(TargetSteeringAngularSpeed) - TurnRateModAngularSpeed);
+		const float MaxSpeedLimit = PrvEvalCurve(MaxSpeedCurve, MaxSpeedCurveTable, FMath::Abs(TargetSteeringAngularSpeed) - TurnRateModAngularSpeed);
 
 		if (CurrentSpeed >= MaxSpeedLimit)
 		{
@@ -1387,7 +2112,7 @@ void UPrvVehicleMovementComponent::UpdateBrake(float DeltaTime)
 	}
 }
 
-void UPrvVehicleMovementComponent::UpdateTracksVelocity(float DeltaTime)
+void UPrvVehicleMovementComponent::UpdateTracksVelocity(float DeltaTime, const FPrvBodySnapshot& Body)
 {
 	// Calc total torque
 	RightTrackTorque = RightTrack.DriveTorque ;
@@ -1410,12 +2135,12 @@ void UPrvVehicleMovementComponent::UpdateTracksVelocity(float DeltaTime)
 	if (bShowDebug)
 	{
 		// Tracks torque
-		DrawDebugString(GetWorld(), UpdatedMesh->GetComponentTransform().TransformPosition(FVector(0.f, -300.f, 0.f)), FString::SanitizeFloat(LeftTrackTorque), nullptr, FColor::White, 0.f);
-		DrawDebugString(GetWorld(), UpdatedMesh->GetComponentTransform().TransformPosition(FVector(0.f, 300.f, 0.f)), FString::SanitizeFloat(RightTrackTorque), nullptr, FColor::White, 0.f);
+		DrawDebugString(GetWorld(), Body.ComponentTransform.TransformPosition(FVector(0.f, -300.f, 0.f)), FString::SanitizeFloat(LeftTrackTorque), nullptr, FColor::White, 0.f);
+		DrawDebugString(GetWorld(), Body.ComponentTransform.TransformPosition(FVector(0.f, 300.f, 0.f)), FString::SanitizeFloat(RightTrackTorque), nullptr, FColor::White, 0.f);
 
 		// Tracks torque
-		DrawDebugString(GetWorld(), UpdatedMesh->GetComponentTransform().TransformPosition(FVector(0.f, -500.f, 0.f)), FString::SanitizeFloat(LeftTrack.AngularSpeed), nullptr, FColor::White, 0.f);
-		DrawDebugString(GetWorld(), UpdatedMesh->GetComponentTransform().TransformPosition(FVector(0.f, 500.f, 0.f)), FString::SanitizeFloat(RightTrack.AngularSpeed), nullptr, FColor::White, 0.f);
+		DrawDebugString(GetWorld(), Body.ComponentTransform.TransformPosition(FVector(0.f, -500.f, 0.f)), FString::SanitizeFloat(LeftTrack.AngularSpeed), nullptr, FColor::White, 0.f);
+		DrawDebugString(GetWorld(), Body.ComponentTransform.TransformPosition(FVector(0.f, 500.f, 0.f)), FString::SanitizeFloat(RightTrack.AngularSpeed), nullptr, FColor::White, 0.f);
 	}
 }
 
@@ -1436,7 +2161,7 @@ void UPrvVehicleMovementComponent::UpdateHullVelocity(float DeltaTime)
 	HullAngularSpeed = (FMath::Abs(LeftTrack.AngularSpeed) + FMath::Abs(RightTrack.AngularSpeed)) / 2.f;
 }
 
-void UPrvVehicleMovementComponent::UpdateEngineStartExtraPower(float DeltaTime)
+void UPrvVehicleMovementComponent::UpdateEngineStartExtraPower(float DeltaTime, const FPrvBodySnapshot& Body)
 {
 	const float CurrentTime = GetWorld()->GetTimeSeconds();
 	if (CurrentTime - StartExtraPowerActivationTime >= StartExtraPowerDuration)
@@ -1444,12 +2169,12 @@ void UPrvVehicleMovementComponent::UpdateEngineStartExtraPower(float DeltaTime)
 		StartExtraPower = 1.f;
 	}
 
-	const float CurrentSpeed = UpdatedMesh->GetComponentVelocity().Size();
+	const float CurrentSpeed = Body.LinearVelocity.Size();
 	const bool bMoving = !FMath::IsNearlyZero(CurrentSpeed, 1.f) && !FMath::IsNearlyZero(FMath::Abs(RawThrottleInput));
 	const bool bStarted = !bStartExtraPowerMovingLast && bMoving && !FMath::IsNearlyZero(FMath::Abs(RawThrottleInput));
 	const bool bCanStartAfterTimeout = bStarted && (FMath::IsNearlyZero(StartExtraPowerActivationTime) || (CurrentTime - StartExtraPowerActivationTime >= StartExtraPowerCooldown));
 
-	const float SpeedSign = FMath::Sign(FVector::DotProduct(UpdatedMesh->GetForwardVector(), UpdatedMesh->GetComponentVelocity()));
+	const float SpeedSign = FMath::Sign(FVector::DotProduct(Body.ForwardVector, Body.LinearVelocity));
 	const bool bWantToMoveOppositeDirection = bMoving && !bStarted && (FMath::Sign(RawThrottleInput) * SpeedSign < 0.f);
 
 	if (bWantToMoveOppositeDirection || bCanStartAfterTimeout)
@@ -1461,32 +2186,36 @@ void UPrvVehicleMovementComponent::UpdateEngineStartExtraPower(float DeltaTime)
 	bStartExtraPowerMovingLast = bMoving;
 }
 
-void UPrvVehicleMovementComponent::UpdateEngine()
+void UPrvVehicleMovementComponent::UpdateEngine(const FPrvBodySnapshot& Body)
 {
 	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateEngine);
 
 	const FGearInfo CurrentGearInfo = GetCurrentGearInfo();
 
 	// Update engine rotation speed (RPM)
-	EngineRPM = PrvOmegaToRPM((CurrentGearInfo.Ratio * DifferentialRatio) * UpdatedMesh->GetPhysicsLinearVelocity().Size()/20);
-	
-	EngineRPM = FMath::Clamp(EngineRPM, MinEngineRPM, MaxEngineRPM);
+	if (HasPhysicsSubstepOutput())
+	{
+		// Physics substeps publish RPM of the latest body speed
+		EngineRPM = SubstepForces->GetOutput().EngineRPM;
+	}
+	else
+	{
+		EngineRPM = PrvSpeedToEngineRPM(CurrentGearInfo.Ratio * DifferentialRatio, Body.LinearVelocity.Size(), MinEngineRPM, MaxEngineRPM);
+	}
 
 	// Calculate engine torque based on current RPM
-	FRichCurve* TorqueCurveData = EngineTorqueCurve.GetRichCurve();
-	const float MaxEngineTorque = bGearTimer && bZeroTorqueWhenShifting ? 0 : TorqueCurveData->Eval(EngineRPM) * 100.f * CustomTorqueMultiplier*MSBoost; // Meters to Cm
+	const float MaxEngineTorque = bGearTimer && bZeroTorqueWhenShifting ? 0 : PrvEvalCurve(EngineTorqueCurve, EngineTorqueCurveTable, EngineRPM) * 100.f * CustomTorqueMultiplier*MSBoost; // Meters to Cm
 
 
 	// Check engine torque limitations
-	const float CurrentSpeed = UpdatedMesh->GetComponentVelocity().Size();
+	const float CurrentSpeed = Body.LinearVelocity.Size();
 	const bool bLimitTorqueByRPM = bLimitEngineTorque && FMath::Abs(EngineRPM - MaxEngineRPM) < SMALL_NUMBER;
 
 	// Check steering limitation
 	bool bLimitTorqueBySpeed = false;
 	if (bLimitMaxSpeed)
 	{
-		FRichCurve* MaxSpeedCurveData = MaxSpeedCurve.GetRichCurve();
-		const float MaxSpeedLimit = MaxSpeedCurveData->Eval(FMath::Abs(TargetSteeringAngularSpeed) - TurnRateModAngularSpeed);
+		const float MaxSpeedLimit = PrvEvalCurve(MaxSpeedCurve, MaxSpeedCurveTable, FMath::Abs(TargetSteeringAngularSpeed) - TurnRateModAngularSpeed);
 
 		bLimitTorqueBySpeed = (CurrentSpeed >= MaxSpeedLimit);
 	}
@@ -1517,19 +2246,19 @@ void UPrvVehicleMovementComponent::UpdateEngine()
 	// Debug
 	if (bShowDebug)
 	{
-		DrawDebugString(GetWorld(), UpdatedMesh->GetComponentTransform().TransformPosition(FVector(0.f, 0.f, 200.f)), FString::SanitizeFloat(EngineRPM), nullptr, FColor::Red, 0.f);
-		DrawDebugString(GetWorld(), UpdatedMesh->GetComponentTransform().TransformPosition(FVector(0.f, 0.f, 250.f)), FString::SanitizeFloat(MaxEngineTorque), nullptr, FColor::White, 0.f);
-		DrawDebugString(GetWorld(), UpdatedMesh->GetComponentTransform().TransformPosition(FVector(0.f, 0.f, 300.f)), FString::SanitizeFloat(DriveTorque), nullptr, FColor::Red, 0.f);
+		DrawDebugString(GetWorld(), Body.ComponentTransform.TransformPosition(FVector(0.f, 0.f, 200.f)), FString::SanitizeFloat(EngineRPM), nullptr, FColor::Red, 0.f);
+		DrawDebugString(GetWorld(), Body.ComponentTransform.TransformPosition(FVector(0.f, 0.f, 250.f)), FString::SanitizeFloat(MaxEngineTorque), nullptr, FColor::White, 0.f);
+		DrawDebugString(GetWorld(), Body.ComponentTransform.TransformPosition(FVector(0.f, 0.f, 300.f)), FString::SanitizeFloat(DriveTorque), nullptr, FColor::Red, 0.f);
 	}
 }
 
-void UPrvVehicleMovementComponent::UpdateDriveForce()
+void UPrvVehicleMovementComponent::UpdateDriveForce(const FPrvBodySnapshot& Body)
 {
 	// Drive force (right)
 	if (bSteeringStabilizerActiveRight == false)
 	{
 		RightTrack.DriveTorque = RightTrack.TorqueTransfer * DriveTorque;
-		RightTrack.DriveForce = UpdatedMesh->GetForwardVector() * (RightTrackTorque / SprocketRadius);
+		RightTrack.DriveForce = Body.ForwardVector * (RightTrackTorque / SprocketRadius);
 	
 	}
 	else
@@ -1542,7 +2271,7 @@ void UPrvVehicleMovementComponent::UpdateDriveForce()
 	if (bSteeringStabilizerActiveLeft == false)
 	{
 		LeftTrack.DriveTorque = LeftTrack.TorqueTransfer * DriveTorque;
-		LeftTrack.DriveForce = UpdatedMesh->GetForwardVector() * (LeftTrackTorque / SprocketRadius);
+		LeftTrack.DriveForce = Body.ForwardVector * (LeftTrackTorque / SprocketRadius);
 	}
 	else
 	{
@@ -1551,9 +2280,9 @@ void UPrvVehicleMovementComponent::UpdateDriveForce()
 	}
 }
 
-void UPrvVehicleMovementComponent::UpdateAntiRollover(float DeltaTime)
+void UPrvVehicleMovementComponent::UpdateAntiRollover(float DeltaTime, const FPrvBodySnapshot& Body)
 {
-	const FVector VehicleZ = UpdatedMesh->GetUpVector();
+	const FVector VehicleZ = Body.UpVector;
 	const FVector WorldZ = FVector::UpVector;
 	const FVector AntiRolloverVector = FVector::CrossProduct(VehicleZ, WorldZ);
 	float DotProduct=FVector::DotProduct(VehicleZ,WorldZ);
@@ -1561,19 +2290,135 @@ void UPrvVehicleMovementComponent::UpdateAntiRollover(float DeltaTime)
 
 	if (DotProduct > LastAntiRolloverValue || DotProduct >= AntiRolloverValueThreshold)
 	{
-		const float TorqueMultiplier = AntiRolloverForceCurve.GetRichCurve()->Eval(DotProduct);
-		UpdatedMesh->AddTorqueInRadians(AntiRolloverVector * TorqueMultiplier);
+		const float TorqueMultiplier = PrvEvalCurve(AntiRolloverForceCurve, AntiRolloverForceCurveTable, DotProduct);
+		ForceAccumulator.AddTorqueInRadians(AntiRolloverVector * TorqueMultiplier);
 	}
 
 	LastAntiRolloverValue = DotProduct;
 	
 }
 
-void UPrvVehicleMovementComponent::UpdateSuspension(float DeltaTime)
+void UPrvVehicleMovementComponent::ProbeWheels(const FPrvBodySnapshot& Body)
+{
+	PRV_CYCLE_COUNTER(STAT_PrvMovementProbeWheels);
+
+	const int32 WheelsNum = SuspensionData.Num();
+	if (SuspensionSimData.Num() != WheelsNum)
+	{
+		InitSuspensionSimData();
+	}
+	else
+	{
+		// Suspension settings can be changed at runtime
+		UpdateSuspensionSimConfig();
+	}
+
+	ProbeWheels(Body, SuspensionData, SuspensionSimData, SuspensionHits, SuspensionHitsBlocking);
+}
+
+void UPrvVehicleMovementComponent::ProbeWheels(const FPrvBodySnapshot& Body, TArray<FSuspensionState>& Wheels, FPrvSuspensionSimData& Sim, TArray<FHitResult>& Hits, TArray<bool>& HitsBlocking)
+{
+	const bool bUseLineTrace = UseLineTrace();
+
+	bBroadphaseActive = UpdateSuspensionBroadphase(Body, bUseLineTrace);
+	UpdateTrackProfiles(Body.ComponentTransform);
+
+	const int32 WheelsNum = Wheels.Num();
+	Hits.SetNum(WheelsNum, false);
+	HitsBlocking.SetNum(WheelsNum, false);
+
+	// Probe the ground under all wheels
+	for (int32 WheelIdx = 0; WheelIdx < WheelsNum; ++WheelIdx)
+	{
+		FSuspensionState& SuspState = Wheels[WheelIdx];
+
+		FPrvWheelProbe Probe;
+		MakeWheelProbe(SuspState, Body.ComponentTransform, bUseLineTrace, Probe);
+
+		Sim.ProbeOrigin[WheelIdx] = Probe.Start;
+		Sim.ProbeDirection[WheelIdx] = Probe.UpVector;
+
+		// Make trace to touch the ground
+		FHitResult& Hit = Hits[WheelIdx];
+		Hit = FHitResult();
+		bool bHitValid = false;
+		HitsBlocking[WheelIdx] = TraceWheel(SuspState, Probe, Hit, bHitValid);
+
+		Sim.Contact[WheelIdx] = bHitValid ? 1 : 0;
+		if (bHitValid)
+		{
+			// Clamp suspension length because MaxDrop distance is for visuals only (non-effective compression)
+			Sim.ContactLength[WheelIdx] = FMath::Clamp(Hit.Distance, 0.f, Sim.Length[WheelIdx]);
+			Sim.ContactLocation[WheelIdx] = Hit.ImpactPoint;
+			Sim.ContactNormal[WheelIdx] = Hit.ImpactNormal;
+		}
+		else
+		{
+			Sim.ContactLength[WheelIdx] = Sim.Length[WheelIdx];
+			Sim.ContactLocation[WheelIdx] = FVector::ZeroVector;
+			Sim.ContactNormal[WheelIdx] = FVector::UpVector;
+		}
+	}
+
+	bBroadphaseActive = false;
+	BroadphaseComponents.Reset();
+	BroadphaseGroundGrid = nullptr;
+}
+
+bool UPrvVehicleMovementComponent::CanProbeWheelsInParallel() const
+{
+	return !UseAsyncTrace() && !UseBakedGround() && !bShowDebug;
+}
+
+int32 UPrvVehicleMovementComponent::ValidateProbeWheels(const FPrvBodySnapshot& Body, const TArray<FSuspensionState>& WheelsBeforeProbes)
+{
+	const FPrvSuspensionSimData& TestedSim = SuspensionSimData;
+	if (WheelsBeforeProbes.Num() != TestedSim.Num())
+	{
+		UE_LOG(LogPrvVehicle, Error, TEXT("%s: Probed wheels number mismatch: %d, reference %d"), *GetNameSafe(GetOwner()), TestedSim.Num(), WheelsBeforeProbes.Num());
+		return FMath::Max(TestedSim.Num(), WheelsBeforeProbes.Num());
+	}
+
+	// Reference probes start from the same coherence cache and write to copies only
+	TArray<FSuspensionState> Wheels = WheelsBeforeProbes;
+	FPrvSuspensionSimData Sim = TestedSim;
+	TArray<FHitResult> Hits;
+	TArray<bool> HitsBlocking;
+	ProbeWheels(Body, Wheels, Sim, Hits, HitsBlocking);
+
+	int32 MismatchesNum = 0;
+	for (int32 WheelIdx = 0; WheelIdx < Sim.Num(); ++WheelIdx)
+	{
+		if (TestedSim.Contact[WheelIdx] != Sim.Contact[WheelIdx] ||
+			!FMath::IsNearlyEqual(TestedSim.ContactLength[WheelIdx], Sim.ContactLength[WheelIdx], KINDA_SMALL_NUMBER) ||
+			!TestedSim.ContactLocation[WheelIdx].Equals(Sim.ContactLocation[WheelIdx], KINDA_SMALL_NUMBER) ||
+			!TestedSim.ContactNormal[WheelIdx].Equals(Sim.ContactNormal[WheelIdx], KINDA_SMALL_NUMBER))
+		{
+			UE_LOG(LogPrvVehicle, Error, TEXT("%s: Wheel %d contact mismatch: contact %d length %f, reference contact %d length %f"),
+				*GetNameSafe(GetOwner()), WheelIdx, TestedSim.Contact[WheelIdx], TestedSim.ContactLength[WheelIdx], Sim.Contact[WheelIdx], Sim.ContactLength[WheelIdx]);
+			MismatchesNum++;
+		}
+	}
+
+	return MismatchesNum;
+}
+
+void UPrvVehicleMovementComponent::UpdateSuspension(float DeltaTime, const FPrvBodySnapshot& Body)
 {
 	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateSuspension);
-const FVector RightVector=UpdatedMesh->GetRightVector();
-UpdatedMesh->AddForce(UKismetMathLibrary::Dot_VectorVector(RightVector,UpdatedMesh->GetPhysicsLinearVelocity())*RightVector*AntiSlipFactor*-1	);
+
+	// Suspension, friction and drive forces are added by physics substeps, wheels are placed by their last results
+	const bool bSubstepForces = UsePhysicsSubstepForces();
+	if (bSubstepForces)
+	{
+		SubstepForces->UpdateOutput();
+	}
+	else
+	{
+		const FVector& RightVector=Body.RightVector;
+		ForceAccumulator.AddForce(UKismetMathLibrary::Dot_VectorVector(RightVector,Body.LinearVelocity)*RightVector*AntiSlipFactor*-1	);
+	}
+
 	// Limit delta time to prevent teleporting vehicles on lag (too much velocity per frame can be applied in this case)
 	static float MaxDeltaTime = 1.f / 15.f;
 	if (DeltaTime > MaxDeltaTime)
@@ -1587,157 +2432,248 @@ UpdatedMesh->AddForce(UKismetMathLibrary::Dot_VectorVector(RightVector,UpdatedMe
 	ActiveFrictionPoints = 0;
 	ActiveDrivenFrictionPoints = 0;
 
-	TArray<AActor*> IgnoredActors;
-	const EDrawDebugTrace::Type DebugType = IsDebug() ? EDrawDebugTrace::ForOneFrame : EDrawDebugTrace::None;
+	// Contacts are made by ProbeWheels()
+	const int32 WheelsNum = SuspensionData.Num();
+	if (SuspensionSimData.Num() != WheelsNum || SuspensionHits.Num() != WheelsNum || SuspensionHitsBlocking.Num() != WheelsNum)
+	{
+		return;
+	}
+
+	const bool bSubstepOutput = HasPhysicsSubstepOutput();
+	const FPrvSubstepOutput* SubstepOutput = bSubstepOutput ? &SubstepForces->GetOutput() : nullptr;
 
-	const bool bUseLineTrace = UseLineTrace();
+	if (bSubstepForces)
+	{
+		// Spring force of the last substep gives wheel load and reaction forces
+		for (int32 WheelIdx = 0; WheelIdx < WheelsNum; ++WheelIdx)
+		{
+			SuspensionSimData.Force[WheelIdx] = bSubstepOutput ? SubstepOutput->Force[WheelIdx] : 0.f;
+		}
+	}
+	else
+	{
+		// Spring and damper of all wheels at once
+		UpdateSuspensionForces(DeltaTime, Body.Mass, Body.GravityZ, ActiveWheelsNum);
+	}
+
+	UPrvVehicleSubsystem* PhysicsCommandQueue = GetPhysicsCommandQueue();
 
-	for (auto& SuspState : SuspensionData)
+	// Apply forces and refresh wheels view
+	for (int32 WheelIdx = 0; WheelIdx < WheelsNum; ++WheelIdx)
 	{
-		const FVector SuspUpVector = UpdatedMesh->GetComponentTransform().TransformVectorNoScale(UKismetMathLibrary::GetUpVector(SuspState.SuspensionInfo.Rotation));
-		const FVector SuspWorldLocation = UpdatedMesh->GetComponentTransform().TransformPosition(SuspState.SuspensionInfo.Location);
-		const FVector SuspTraceEndLocation = SuspWorldLocation - SuspUpVector * (SuspState.SuspensionInfo.Length + SuspState.SuspensionInfo.MaxDrop);
-		const FVector RadiusUpVector = SuspUpVector * SuspState.SuspensionInfo.CollisionRadius;
+		FSuspensionState& SuspState = SuspensionData[WheelIdx];
+		const FHitResult& Hit = SuspensionHits[WheelIdx];
+		const bool bHit = SuspensionHitsBlocking[WheelIdx];
+		const bool bHitValid = SuspensionSimData.Contact[WheelIdx] != 0;
 
-		// Make trace to touch the ground
-		FHitResult Hit;
-		bool bHit = false;
-		bool bHitValid = false;
+		const FVector& SuspUpVector = SuspensionSimData.ProbeDirection[WheelIdx];
+		const FVector& SuspWorldLocation = SuspensionSimData.ProbeOrigin[WheelIdx];
 
-		// For cylindrical wheels only
-		if (FMath::Abs(DefaultCollisionWidth) > SMALL_NUMBER && !bUseLineTrace)
-		{
-			TArray<FHitResult> Hits;
+		SuspState.PreviousLength = SuspensionSimData.PreviousLength[WheelIdx];
+		SuspState.WheelCollisionLocation = SuspensionSimData.ContactLocation[WheelIdx];
+		SuspState.WheelCollisionNormal = SuspensionSimData.ContactNormal[WheelIdx];
+		SuspState.WheelTouchedGround = bHitValid;
 
-#if ENGINE_MINOR_VERSION >= 15
-			bHit = UKismetSystemLibrary::SphereTraceMulti(this, SuspWorldLocation, SuspTraceEndLocation, SuspState.SuspensionInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hits, true);
-#else
-			bHit = UKismetSystemLibrary::SphereTraceMulti_NEW(this, SuspWorldLocation, SuspTraceEndLocation, SuspState.SuspensionInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hits, true);
-#endif
+		// Process hit results
+		if (bHitValid)
+		{
+			const FVector SuspensionDirection = (bWheeledVehicle) ? Hit.ImpactNormal : SuspUpVector;
+			SuspState.SuspensionForce = SuspensionSimData.Force[WheelIdx] * SuspensionDirection;
+			SuspState.SurfaceType = GetWheelSurfaceType(Hit);
 
-			// Process hits and find the best one
-			float BestDistanceSquared = MAX_FLT;
-			for (auto MyHit : Hits)
+			const float VisualDistance = (bSubstepOutput && SubstepOutput->ContactDistance[WheelIdx] >= 0.f) ? SubstepOutput->ContactDistance[WheelIdx] : Hit.Distance;
+			if (SuspState.VisualLength < VisualDistance)
 			{
-				// Ignore overlap
-				if (!MyHit.bBlockingHit)
-				{
-					continue;
-				}
+				SuspState.VisualLength = FMath::Lerp(SuspState.VisualLength, VisualDistance, FMath::Clamp(DeltaTime * DropFactor, 0.f, 1.f));
+			}
+			else
+			{
+				SuspState.VisualLength = VisualDistance;
+			}
 
-				FVector HitLocation_SuspSpace = FVector::ZeroVector;
+			// Current wheel touches ground
+			ActiveFrictionPoints++;
 
-				// Check that it was penetration hit
-				if (MyHit.bStartPenetrating)
-				{
-					HitLocation_SuspSpace = (MyHit.PenetrationDepth - SuspState.SuspensionInfo.CollisionRadius) * UpdatedMesh->GetComponentTransform().InverseTransformVectorNoScale(MyHit.Normal);
-				}
-				else
-				{
-					// Transform into wheel space
-					HitLocation_SuspSpace = UpdatedMesh->GetComponentTransform().InverseTransformPosition(MyHit.ImpactPoint) - SuspState.SuspensionInfo.Location;
-				}
+			// Active driving wheels are calculated separately (has sense for cars only)
+			if (!bWheeledVehicle || SuspState.SuspensionInfo.bDrivingWheel)
+			{
+				ActiveDrivenFrictionPoints++;
+			}
+		}
+		else
+		{
+			// If there is no collision then suspension is relaxed
+			SuspState.SuspensionForce = FVector::ZeroVector;
+			SuspState.VisualLength = FMath::Lerp(SuspState.VisualLength, SuspState.SuspensionInfo.Length + SuspState.SuspensionInfo.MaxDrop, FMath::Clamp(DeltaTime * DropFactor, 0.f, 1.f)); // @todo Make it non-momental
+			SuspState.SurfaceType = EPhysicalSurface::SurfaceType_Default;
+		}
 
-				// Apply reverse wheel rotation
-				HitLocation_SuspSpace = SuspState.SuspensionInfo.Rotation.UnrotateVector(HitLocation_SuspSpace);
+		// Add suspension force if spring compressed
+		if (Body.bAddForce && !bSubstepForces && !SuspState.SuspensionForce.IsZero())
+		{
+			ForceAccumulator.AddForceAtLocation(SuspState.SuspensionForce, SuspWorldLocation);
+		}
 
-				// Check that is outside the cylinder
-				if (FMath::Abs(HitLocation_SuspSpace.Y) < (SuspState.SuspensionInfo.CollisionWidth / 2.f))
+		// Push suspension force to environment
+		if (bHit)
+		{
+			UPrimitiveComponent* PrimitiveComponent = Hit.Component.Get();
+			if (PrimitiveComponent)
+			{
+				// Generate hit event
+				if (bNotifyRigidBodyCollision)
 				{
-					// Select the nearest one
-					if (HitLocation_SuspSpace.SizeSquared() < BestDistanceSquared)
-					{
-						BestDistanceSquared = HitLocation_SuspSpace.SizeSquared();
-
-						Hit = MyHit;
-						bHitValid = true;
-					}
+					UpdatedMesh->DispatchBlockingHit(*GetOwner(), Hit);
 				}
 
-				// Debug hit points
-				if (bShowDebug)
+				// Push the force
+				if (PrimitiveComponent->IsSimulatingPhysics())
 				{
-					DrawDebugPoint(GetWorld(), UpdatedMesh->GetComponentTransform().TransformPosition(SuspState.SuspensionInfo.Location + SuspState.SuspensionInfo.Rotation.RotateVector(HitLocation_SuspSpace)), 5.f, FColor::Green, false, /*LifeTime*/ 0.f);
+					AddReactionForce(PrimitiveComponent, -SuspState.SuspensionForce * ReactionForceScale, SuspWorldLocation);
 				}
 			}
 		}
-		else
+
+		// Debug
+		if (bShowDebug)
 		{
-			if (bUseLineTrace)
-			{
-#if ENGINE_MINOR_VERSION >= 15
-				bHit = UKismetSystemLibrary::LineTraceSingle(this, SuspWorldLocation + RadiusUpVector, SuspTraceEndLocation - RadiusUpVector, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
-#else
-				bHit = UKismetSystemLibrary::LineTraceSingle_NEW(this, SuspWorldLocation + RadiusUpVector, SuspTraceEndLocation - RadiusUpVector, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
-#endif
-			}
-			else
+			// Suspension force
+			DrawDebugLine(GetWorld(), SuspWorldLocation, SuspWorldLocation + SuspState.SuspensionForce * 0.0001f, FColor::Green, false, /*LifeTime*/ 0.f, /*DepthPriority*/ 0, /*Thickness*/ 4.f);
+
+			// Suspension length
+			DrawDebugPoint(GetWorld(), SuspWorldLocation, 5.f, FColor(200, 0, 230), false, /*LifeTime*/ 0.f);
+			DrawDebugLine(GetWorld(), SuspWorldLocation, SuspWorldLocation - SuspUpVector * SuspState.PreviousLength, FColor::Blue, false, 0.f, 0, 4.f);
+			DrawDebugLine(GetWorld(), SuspWorldLocation, SuspWorldLocation - SuspUpVector * SuspState.SuspensionInfo.Length, FColor::Red, false, 0.f, 0, 2.f);
+
+			// Draw wheel
+			if (bHit && SuspState.SuspensionInfo.CollisionWidth != 0.f)
 			{
-#if ENGINE_MINOR_VERSION >= 15
-				bHit = UKismetSystemLibrary::SphereTraceSingle(this, SuspWorldLocation, SuspTraceEndLocation, SuspState.SuspensionInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
-#else
-				bHit = UKismetSystemLibrary::SphereTraceSingle_NEW(this, SuspWorldLocation, SuspTraceEndLocation, SuspState.SuspensionInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
-#endif
+				FColor WheelColor = bHitValid ? FColor::Cyan : FColor::White;
+				FVector LineOffset = Body.ComponentTransform.GetRotation().RotateVector(FVector(0.f, SuspState.SuspensionInfo.CollisionWidth / 2.f, 0.f));
+				LineOffset = SuspState.SuspensionInfo.Rotation.RotateVector(LineOffset);
+				DrawDebugCylinder(GetWorld(), Hit.Location - LineOffset, Hit.Location + LineOffset, SuspState.SuspensionInfo.CollisionRadius, 16, WheelColor, false, /*LifeTime*/ 0.f, 100);
 			}
-
-			bHitValid = bHit;
 		}
+	}
+
+	FlushReactionForces(PhysicsCommandQueue);
+}
+
+void UPrvVehicleMovementComponent::UpdateSuspensionForces(float DeltaTime, float VehicleMass, float GravityZ, int32 ActiveWheelsNum)
+{
+	FPrvSuspensionSimData& Sim = SuspensionSimData;
+
+	const float InvDeltaTime = 1.f / DeltaTime;
+	const bool bSimdSuspension = (GPrvVehicleSimdSuspension != 0);
+	const bool bValidateSimdSuspension = bSimdSuspension && (GPrvVehicleValidateSimdSuspension != 0);
+
+	// Compression, velocity and damping of all wheels
+	if (bValidateSimdSuspension)
+	{
+		FPrvSuspensionKernel::ValidatePrepareSpringDamper(Sim, InvDeltaTime, KINDA_SMALL_NUMBER);
+	}
 
-		// Conver line hit to "sphere" hit
-		if (bUseLineTrace && bHitValid)
+	if (bSimdSuspension)
+	{
+		FPrvSuspensionKernel::PrepareSpringDamper(Sim, InvDeltaTime);
+	}
+	else
+	{
+		FPrvSuspensionKernel::PrepareSpringDamperScalar(Sim, InvDeltaTime);
+	}
+
+	// Implicit integration needs the mass each wheel with contact carries on this tick
+	float ImplicitDeltaTime = 0.f;
+	float InvWheelMass = 0.f;
+	if (bImplicitSuspension && GPrvVehicleImplicitSuspension != 0 && VehicleMass > SMALL_NUMBER)
+	{
+		int32 ContactsNum = 0;
+		for (int32 WheelIdx = 0; WheelIdx < Sim.Num(); ++WheelIdx)
 		{
-			Hit.Location = Hit.ImpactPoint + RadiusUpVector;
-			Hit.Distance = (Hit.Location - SuspWorldLocation).Size();
+			ContactsNum += (Sim.Contact[WheelIdx] != 0) ? 1 : 0;
 		}
 
-		// Additional check that hit is valid (for non-spherical wheel)
-		if (bHitValid)
-		{
-			// Transform impact point to actor space
-			const FVector HitActorLocation = UpdatedMesh->GetComponentTransform().InverseTransformPosition(Hit.ImpactPoint);
+		ImplicitDeltaTime = DeltaTime;
+		InvWheelMass = ContactsNum / VehicleMass;
 
-			// Check that collision is under suspension
-			if (HitActorLocation.Z >= SuspState.SuspensionInfo.Location.Z)
+		// Gravity compresses suspension during the step too, so damper should resist it already
+		for (int32 WheelIdx = 0; WheelIdx < Sim.Num(); ++WheelIdx)
+		{
+			if (Sim.Contact[WheelIdx] != 0)
 			{
-				if (bDebugSuspensionLimits)
-				{
-					UE_LOG(LogPrvVehicle, Warning, TEXT("Susp Hit Forced to Zero: Collision.Z: %f, Suspension.Z: %f"), HitActorLocation.Z, SuspState.SuspensionInfo.Location.Z);
-				}
-
-				// Force maximum compression
-				Hit.ImpactPoint = SuspWorldLocation;
-				Hit.ImpactNormal = SuspUpVector;
-				Hit.Distance = 0.f;
+				Sim.Velocity[WheelIdx] += GravityZ * Sim.ProbeDirection[WheelIdx].Z * DeltaTime;
 			}
 		}
+	}
 
-		// Process hit results
-		if (bHitValid)
+	// Implicit integration already accounts for the discrete step
+	const bool bDampingCorrection = (bCustomDampingCorrection || bAdaptiveDampingCorrection) && ImplicitDeltaTime <= 0.f;
+
+	// Damping correction depends on vehicle state, so it's made per wheel
+	if (bDampingCorrection && UseDampingCorrectionTables() && VehicleMass > SMALL_NUMBER)
+	{
+		UpdateDampingCorrectionTables(VehicleMass);
+
+		const bool bCustomCorrection = bCustomDampingCorrection && FMath::Abs(DampingCorrectionFactor) > SMALL_NUMBER;
+		const bool bValidateTables = (GPrvVehicleValidateDampingCorrectionTables != 0);
+
+		for (int32 WheelIdx = 0; WheelIdx < Sim.Num(); ++WheelIdx)
 		{
-			// Clamp suspension length because MaxDrop distance is for visuals only (non-effective compression)
-			const float NewSuspensionLength = FMath::Clamp(Hit.Distance, 0.f, SuspState.SuspensionInfo.Length);
+			if (Sim.Contact[WheelIdx] == 0)
+			{
+				continue;
+			}
 
-			const float SpringCompressionRatio = FMath::Clamp((SuspState.SuspensionInfo.Length - NewSuspensionLength) / SuspState.SuspensionInfo.Length, 0.f, 1.f);
-			const float TargetVelocity = 0.f; // @todo Target velocity can be different for wheeled vehicles
+			const float DiscreteSuspensionVelocity = Sim.Velocity[WheelIdx];
+			const float SuspensionDamping = Sim.Damping[WheelIdx];
 
-			// Original suspension velocity
-			const float DiscreteSuspensionVelocity = (NewSuspensionLength - SuspState.PreviousLength) / DeltaTime;
+			if (bCustomCorrection && FMath::Abs(DiscreteSuspensionVelocity) > SMALL_NUMBER)
+			{
+				const int32 TableIdx = (DiscreteSuspensionVelocity < 0.f) ? Sim.CompressionCorrectionTable[WheelIdx] : Sim.DecompressionCorrectionTable[WheelIdx];
+				const float VelocityScale = DampingCorrectionTables[TableIdx].GetVelocityScale(DeltaTime);
 
-			float SuspensionForce = 0.f;
+				if (bValidateTables)
+				{
+					const float ReferenceScale = FPrvDampingCorrection::CalcVelocityScale(Sim.Stiffness[WheelIdx], SuspensionDamping, VehicleMass, DeltaTime, DampingCorrectionFactor);
+					if (!FMath::IsNearlyEqual(VelocityScale, ReferenceScale, FMath::Abs(ReferenceScale) * 1.e-3f))
+					{
+						UE_LOG(LogPrvVehicle, Error, TEXT("Damping correction table mismatch on wheel %d: velocity scale %f, closed form %f (DeltaTime: %f)"), WheelIdx, VelocityScale, ReferenceScale, DeltaTime);
+					}
+				}
 
-			// Compression and decompression have different suspension quality
-			float SuspensionDamping = 0.f;
-			const float SuspensionStiffness = SuspState.SuspensionInfo.Stiffness * StiffnessFactor;
+				Sim.Velocity[WheelIdx] = DiscreteSuspensionVelocity * VelocityScale;
+			}
 
-			if (DiscreteSuspensionVelocity < 0)
+			if (bAdaptiveDampingCorrection)
 			{
-				SuspensionDamping = SuspState.SuspensionInfo.CompressionDamping * CompressionDampingFactor;
+				const float DampingScale = FPrvDampingCorrection::GetAdaptiveDampingScale(SuspensionDamping, VehicleMass, ActiveWheelsNum, DeltaTime);
+
+				if (bValidateTables)
+				{
+					const float ReferenceScale = FPrvDampingCorrection::CalcAdaptiveDampingScale(SuspensionDamping, VehicleMass, ActiveWheelsNum, DeltaTime);
+					if (!FMath::IsNearlyEqual(DampingScale, ReferenceScale, FMath::Abs(ReferenceScale) * 1.e-3f))
+					{
+						UE_LOG(LogPrvVehicle, Error, TEXT("Adaptive damping table mismatch on wheel %d: damping scale %f, closed form %f"), WheelIdx, DampingScale, ReferenceScale);
+					}
+				}
+
+				Sim.Damping[WheelIdx] = SuspensionDamping * DampingScale;
 			}
-			else
+		}
+	}
+	else if (bDampingCorrection)
+	{
+		for (int32 WheelIdx = 0; WheelIdx < Sim.Num(); ++WheelIdx)
+		{
+			if (Sim.Contact[WheelIdx] == 0)
 			{
-				SuspensionDamping = SuspState.SuspensionInfo.DecompressionDamping * DecompressionDampingFactor;
+				continue;
 			}
 
+			const float DiscreteSuspensionVelocity = Sim.Velocity[WheelIdx];
+			const float SuspensionStiffness = Sim.Stiffness[WheelIdx];
+			float SuspensionDamping = Sim.Damping[WheelIdx];
+
 			// Check we should correct the damping
 			float SuspensionVelocity = DiscreteSuspensionVelocity;
 			if (bCustomDampingCorrection && FMath::Abs(DampingCorrectionFactor) > SMALL_NUMBER && FMath::Abs(DiscreteSuspensionVelocity) > SMALL_NUMBER)
@@ -1746,7 +2682,7 @@ UpdatedMesh->AddForce(UKismetMathLibrary::Dot_VectorVector(RightVector,UpdatedMe
 				const float suspVel = DiscreteSuspensionVelocity / 100.f;
 				const float k = SuspensionStiffness / 100.f;
 				const float D = SuspensionDamping / 100.f;
-				const float m = UpdatedMesh->GetMass();		   // VehicleMass
+				const float m = VehicleMass;		   // VehicleMass
 				const float b = SuspensionDamping / (2.f * m); // DampingCoefficient
 				const float a_lin = FMath::Square(b) - (k / m);
 				const float a = FMath::Sqrt(FMath::Max(1.f, a_lin)); // FrictionCoefficient
@@ -1773,7 +2709,7 @@ UpdatedMesh->AddForce(UKismetMathLibrary::Dot_VectorVector(RightVector,UpdatedMe
 			if (bAdaptiveDampingCorrection)
 			{
 				const float D = SuspensionDamping / 100.f;
-				const float m = UpdatedMesh->GetMass(); // VehicleMass
+				const float m = VehicleMass; // VehicleMass
 
 				const float AdaptiveExp = (1 - FMath::Exp((-D) * ActiveWheelsNum / m * DeltaTime));
 				if (FMath::Abs(AdaptiveExp) > SMALL_NUMBER)
@@ -1794,332 +2730,1093 @@ UpdatedMesh->AddForce(UKismetMathLibrary::Dot_VectorVector(RightVector,UpdatedMe
 				}
 			}
 
-			// Apply suspension force
-			SuspensionForce = (TargetVelocity - SuspensionVelocity) * SuspensionDamping + SpringCompressionRatio * SuspensionStiffness;
+			Sim.Velocity[WheelIdx] = SuspensionVelocity;
+			Sim.Damping[WheelIdx] = SuspensionDamping;
+		}
+	}
+
+	// Spring-damper force of all wheels
+	if (bValidateSimdSuspension)
+	{
+		FPrvSuspensionKernel::ValidateSolveSpringDamper(Sim, bClampSuspensionForce, ImplicitDeltaTime, InvWheelMass, KINDA_SMALL_NUMBER);
+	}
+
+	if (bSimdSuspension)
+	{
+		FPrvSuspensionKernel::SolveSpringDamper(Sim, bClampSuspensionForce, ImplicitDeltaTime, InvWheelMass);
+	}
+	else
+	{
+		FPrvSuspensionKernel::SolveSpringDamperScalar(Sim, bClampSuspensionForce, ImplicitDeltaTime, InvWheelMass);
+	}
 
-			if (SuspensionForce < 0.f)
+	if (!bClampSuspensionForce)
+	{
+		for (int32 WheelIdx = 0; WheelIdx < Sim.Num(); ++WheelIdx)
+		{
+			if (Sim.Force[WheelIdx] < 0.f)
 			{
-				if (bClampSuspensionForce)
-				{
-					SuspensionForce = 0.f;
-				}
-				else
-				{
-					UE_LOG(LogPrvVehicle, Warning, TEXT("Negative SuspensionForce = %f"), SuspensionForce);
-				}
+				UE_LOG(LogPrvVehicle, Warning, TEXT("Negative SuspensionForce = %f"), Sim.Force[WheelIdx]);
 			}
+		}
+	}
+}
 
-			const FVector SuspensionDirection = (bWheeledVehicle) ? Hit.ImpactNormal : SuspUpVector;
-			SuspState.SuspensionForce = SuspensionForce * SuspensionDirection;
+void UPrvVehicleMovementComponent::UpdateDampingCorrectionTables(float VehicleMass)
+{
+	FPrvSuspensionSimData& Sim = SuspensionSimData;
 
-			SuspState.WheelCollisionLocation = Hit.ImpactPoint;
-			SuspState.WheelCollisionNormal = Hit.ImpactNormal;
-			SuspState.PreviousLength = NewSuspensionLength;
-			SuspState.WheelTouchedGround = true;
-			SuspState.SurfaceType = UGameplayStatics::GetSurfaceType(Hit);
+	bool bTablesValid = DampingCorrectionTables.Num() > 0 &&
+		DampingCorrectionTablesMass == VehicleMass &&
+		DampingCorrectionTablesFactor == DampingCorrectionFactor;
 
-			if (SuspState.VisualLength < Hit.Distance)
-			{
-				SuspState.VisualLength = FMath::Lerp(SuspState.VisualLength, Hit.Distance, FMath::Clamp(DeltaTime * DropFactor, 0.f, 1.f));
-			}
-			else
-			{
-				SuspState.VisualLength = Hit.Distance;
-			}
+	// Each wheel should still point to the table of its own stiffness and damping
+	auto IsTableOf = [this](int32 TableIdx, float Stiffness, float Damping)
+	{
+		return DampingCorrectionTables.IsValidIndex(TableIdx) && DampingCorrectionTables[TableIdx].Stiffness == Stiffness && DampingCorrectionTables[TableIdx].Damping == Damping;
+	};
 
-			// Current wheel touches ground
-			ActiveFrictionPoints++;
+	for (int32 WheelIdx = 0; bTablesValid && WheelIdx < Sim.Num(); ++WheelIdx)
+	{
+		bTablesValid = IsTableOf(Sim.CompressionCorrectionTable[WheelIdx], Sim.Stiffness[WheelIdx], Sim.CompressionDamping[WheelIdx]) &&
+			IsTableOf(Sim.DecompressionCorrectionTable[WheelIdx], Sim.Stiffness[WheelIdx], Sim.DecompressionDamping[WheelIdx]);
+	}
 
-			// Active driving wheels are calculated separately (has sense for cars only)
-			if (!bWheeledVehicle || SuspState.SuspensionInfo.bDrivingWheel)
-			{
-				ActiveDrivenFrictionPoints++;
-			}
-		}
-		else
+	if (bTablesValid)
+	{
+		return;
+	}
+
+	DampingCorrectionTables.Reset();
+	DampingCorrectionTablesMass = VehicleMass;
+	DampingCorrectionTablesFactor = DampingCorrectionFactor;
+
+	// Most wheels share the same setup, so one table serves many wheels
+	auto FindOrAddTable = [this, VehicleMass](float Stiffness, float Damping)
+	{
+		const int32 ExistingIdx = DampingCorrectionTables.IndexOfByPredicate([Stiffness, Damping](const FPrvDampingCorrectionTable& Table)
 		{
-			// If there is no collision then suspension is relaxed
-			SuspState.SuspensionForce = FVector::ZeroVector;
-			SuspState.WheelCollisionLocation = FVector::ZeroVector;
-			SuspState.WheelCollisionNormal = FVector::UpVector;
-			SuspState.PreviousLength = SuspState.SuspensionInfo.Length;
-			SuspState.VisualLength = FMath::Lerp(SuspState.VisualLength, SuspState.SuspensionInfo.Length + SuspState.SuspensionInfo.MaxDrop, FMath::Clamp(DeltaTime * DropFactor, 0.f, 1.f)); // @todo Make it non-momental
-			SuspState.WheelTouchedGround = false;
-			SuspState.SurfaceType = EPhysicalSurface::SurfaceType_Default;
+			return Table.Stiffness == Stiffness && Table.Damping == Damping;
+		});
+
+		if (ExistingIdx != INDEX_NONE)
+		{
+			return ExistingIdx;
 		}
 
-		// Add suspension force if spring compressed
-		if (ShouldAddForce() && !SuspState.SuspensionForce.IsZero())
+		const int32 TableIdx = DampingCorrectionTables.AddDefaulted();
+		DampingCorrectionTables[TableIdx].Build(Stiffness, Damping, VehicleMass, DampingCorrectionFactor);
+		return TableIdx;
+	};
+
+	for (int32 WheelIdx = 0; WheelIdx < Sim.Num(); ++WheelIdx)
+	{
+		Sim.CompressionCorrectionTable[WheelIdx] = FindOrAddTable(Sim.Stiffness[WheelIdx], Sim.CompressionDamping[WheelIdx]);
+		Sim.DecompressionCorrectionTable[WheelIdx] = FindOrAddTable(Sim.Stiffness[WheelIdx], Sim.DecompressionDamping[WheelIdx]);
+	}
+}
+
+bool UPrvVehicleMovementComponent::UseDampingCorrectionTables() const
+{
+	return (GPrvVehicleDampingCorrectionTables != 0) && !bDebugDampingCorrection;
+}
+
+void UPrvVehicleMovementComponent::UpdateSuspensionVisualsOnly(float DeltaTime, const FPrvBodySnapshot& Body)
+{
+	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateSuspensionVisualsOnly);
+
+	// Suspension
+	if (bShouldAnimateWheels)
+	{
+		// For simulated proxy, suspension use line trace
+		bool bUseLineTrace = UseLineTrace();
+
+		if (!bUseLineTrace && bSimplifiedSuspensionByCamera)
 		{
-			
-			UpdatedMesh->AddForceAtLocation(SuspState.SuspensionForce, SuspWorldLocation);
+			FVector RelativeCameraVector;
+			FVector RelativeMeshForwardVector;
+			if (GetCameraVector(RelativeCameraVector, RelativeMeshForwardVector))
+			{
+				RelativeCameraVector.Z = 0;
+				if (RelativeCameraVector.SizeSquared() > SMALL_NUMBER)
+				{
+					RelativeCameraVector.Normalize();
+					if (FMath::Abs(RelativeCameraVector | RelativeMeshForwardVector) > 0.9f)
+					{
+						bUseLineTrace = true;
+					}
+				}
+			}
 		}
 
-		// Push suspension force to environment
-		if (bHit)
+		// Probe only part of wheels per frame
+		const int32 ProbeDivisor = FMath::Min(GetVisualsOnlyProbeDivisor(), FMath::Max(1, SuspensionData.Num()));
+		const int32 ProbePhase = VisualsOnlyProbePhase % ProbeDivisor;
+		VisualsOnlyProbePhase = (ProbePhase + 1) % ProbeDivisor;
+
+		bBroadphaseActive = UpdateSuspensionBroadphase(Body, bUseLineTrace);
+		UpdateTrackProfiles(Body.ComponentTransform);
+
+		for (int32 WheelIdx = 0; WheelIdx < SuspensionData.Num(); ++WheelIdx)
 		{
-			UPrimitiveComponent* PrimitiveComponent = Hit.Component.Get();
-			if (PrimitiveComponent)
+			if (WheelIdx % ProbeDivisor != ProbePhase)
 			{
-				// Generate hit event
-				if (bNotifyRigidBodyCollision)
+				continue;
+			}
+
+			FSuspensionState& SuspState = SuspensionData[WheelIdx];
+
+			FPrvWheelProbe Probe;
+			MakeWheelProbe(SuspState, Body.ComponentTransform, bUseLineTrace, Probe);
+
+			const FVector& SuspUpVector = Probe.UpVector;
+			const FVector& SuspWorldLocation = Probe.Start;
+
+			// Make trace to touch the ground
+			FHitResult Hit;
+			bool bHitValid = false;
+			const bool bHit = TraceWheel(SuspState, Probe, Hit, bHitValid);
+
+			// Process hit results
+			if (bHitValid)
+			{
+				// Clamp suspension length because MaxDrop distance is for visuals only (non-effective compression)
+				const float NewSuspensionLength = FMath::Clamp(Hit.Distance, 0.f, SuspState.SuspensionInfo.Length);
+
+				const float SpringCompressionRatio = FMath::Clamp((SuspState.SuspensionInfo.Length - NewSuspensionLength) / SuspState.SuspensionInfo.Length, 0.f, 1.f);
+
+				SuspState.SampledLength = Hit.Distance;
+				SuspState.WheelCollisionLocation = Hit.ImpactPoint;
+				SuspState.WheelCollisionNormal = Hit.ImpactNormal;
+				SuspState.PreviousLength = NewSuspensionLength;
+				SuspState.WheelTouchedGround = true;
+				SuspState.SurfaceType = GetWheelSurfaceType(Hit);
+
+				if (SuspState.VisualLength < Hit.Distance)
 				{
-					UpdatedMesh->DispatchBlockingHit(*GetOwner(), Hit);
+					SuspState.VisualLength = FMath::Lerp(SuspState.VisualLength, Hit.Distance, FMath::Clamp(DeltaTime * DropFactor, 0.f, 1.f));
 				}
+				else
+				{
+					SuspState.VisualLength = Hit.Distance;
+				}
+			}
+			else
+			{
+				// If there is no collision then suspension is relaxed
+				SuspState.SuspensionForce = FVector::ZeroVector;
+				SuspState.WheelCollisionLocation = FVector::ZeroVector;
+				SuspState.WheelCollisionNormal = FVector::UpVector;
+				SuspState.PreviousLength = SuspState.SuspensionInfo.Length;
+				SuspState.SampledLength = SuspState.SuspensionInfo.Length + SuspState.SuspensionInfo.MaxDrop;
+				SuspState.VisualLength = FMath::Lerp(SuspState.VisualLength, SuspState.SampledLength, FMath::Clamp(DeltaTime * DropFactor, 0.f, 1.f));
+				SuspState.WheelTouchedGround = false;
+				SuspState.SurfaceType = EPhysicalSurface::SurfaceType_Default;
+			}
 
-				// Push the force
-				if (PrimitiveComponent->IsSimulatingPhysics())
+			// Keep spring state continuous if the vehicle becomes simulated
+			if (SuspensionSimData.Num() == SuspensionData.Num())
+			{
+				SuspensionSimData.PreviousLength[WheelIdx] = SuspState.PreviousLength;
+			}
+
+			// @todo Possible push some suspension force to environment
+
+			// Debug
+			if (bShowDebug)
+			{
+				// Suspension length
+				DrawDebugPoint(GetWorld(), SuspWorldLocation, 5.f, FColor(200, 0, 230), false, /*LifeTime*/ 0.f);
+				DrawDebugLine(GetWorld(), SuspWorldLocation, SuspWorldLocation - SuspUpVector * SuspState.PreviousLength, FColor::Blue, false, 0.f, 0, 4.f);
+				DrawDebugLine(GetWorld(), SuspWorldLocation, SuspWorldLocation - SuspUpVector * SuspState.SuspensionInfo.Length, FColor::Red, false, 0.f, 0, 2.f);
+
+				// Draw wheel
+				if (bHit && SuspState.SuspensionInfo.CollisionWidth != 0.f)
 				{
-					PrimitiveComponent->AddForceAtLocation(-SuspState.SuspensionForce, SuspWorldLocation);
+					FColor WheelColor = bHitValid ? FColor::Cyan : FColor::White;
+					FVector LineOffset = Body.ComponentTransform.GetRotation().RotateVector(FVector(0.f, SuspState.SuspensionInfo.CollisionWidth / 2.f, 0.f));
+					LineOffset = SuspState.SuspensionInfo.Rotation.RotateVector(LineOffset);
+					DrawDebugCylinder(GetWorld(), Hit.Location - LineOffset, Hit.Location + LineOffset, SuspState.SuspensionInfo.CollisionRadius, 16, WheelColor, false, /*LifeTime*/ 0.f, 100);
 				}
 			}
 		}
 
-		// Debug
-		if (bShowDebug)
+		bBroadphaseActive = false;
+		BroadphaseComponents.Reset();
+		BroadphaseGroundGrid = nullptr;
+
+		if (ProbeDivisor > 1)
 		{
-			// Suspension force
-			DrawDebugLine(GetWorld(), SuspWorldLocation, SuspWorldLocation + SuspState.SuspensionForce * 0.0001f, FColor::Green, false, /*LifeTime*/ 0.f, /*DepthPriority*/ 0, /*Thickness*/ 4.f);
+			InterpolateSkippedWheels(DeltaTime, ProbeDivisor, ProbePhase);
+		}
+	}
 
-			// Suspension length
-			DrawDebugPoint(GetWorld(), SuspWorldLocation, 5.f, FColor(200, 0, 230), false, /*LifeTime*/ 0.f);
-			DrawDebugLine(GetWorld(), SuspWorldLocation, SuspWorldLocation - SuspUpVector * SuspState.PreviousLength, FColor::Blue, false, 0.f, 0, 4.f);
-			DrawDebugLine(GetWorld(), SuspWorldLocation, SuspWorldLocation - SuspUpVector * SuspState.SuspensionInfo.Length, FColor::Red, false, 0.f, 0, 2.f);
+	// -- [Car] --
+	if (bWheeledVehicle)
+	{
+		// Update driving wheels for wheeled vehicles
+		for (auto& SuspState : SuspensionData)
+		{
+			if (SuspState.SuspensionInfo.bSteeringWheel)
+			{
+				SuspState.SuspensionInfo.Rotation.Yaw = FMath::Lerp(SuspState.SuspensionInfo.Rotation.Yaw, EffectiveSteeringAngularSpeed, DeltaTime * (SteeringUpRatio + SteeringDownRatio) / 2.f);
+			}
+		}
+	}
+}
 
-			// Draw wheel
-			if (bHit && SuspState.SuspensionInfo.CollisionWidth != 0.f)
+void UPrvVehicleMovementComponent::InterpolateSkippedWheels(float DeltaTime, int32 ProbeDivisor, int32 ProbePhase)
+{
+	// Find nearest wheel on the same track (wheels are set up along the track)
+	auto FindTrackNeighbor = [this](int32 WheelIdx, int32 Step) -> const FSuspensionState*
+	{
+		const bool bRightTrack = SuspensionData[WheelIdx].SuspensionInfo.bRightTrack;
+		for (int32 Idx = WheelIdx + Step; SuspensionData.IsValidIndex(Idx); Idx += Step)
+		{
+			if (SuspensionData[Idx].SuspensionInfo.bRightTrack == bRightTrack)
 			{
-				FColor WheelColor = bHitValid ? FColor::Cyan : FColor::White;
-				FVector LineOffset = UpdatedMesh->GetComponentTransform().GetRotation().RotateVector(FVector(0.f, SuspState.SuspensionInfo.CollisionWidth / 2.f, 0.f));
-				LineOffset = SuspState.SuspensionInfo.Rotation.RotateVector(LineOffset);
-				DrawDebugCylinder(GetWorld(), Hit.Location - LineOffset, Hit.Location + LineOffset, SuspState.SuspensionInfo.CollisionRadius, 16, WheelColor, false, /*LifeTime*/ 0.f, 100);
+				return &SuspensionData[Idx];
 			}
 		}
+
+		return nullptr;
+	};
+
+	for (int32 WheelIdx = 0; WheelIdx < SuspensionData.Num(); ++WheelIdx)
+	{
+		if (WheelIdx % ProbeDivisor == ProbePhase)
+		{
+			continue;
+		}
+
+		FSuspensionState& SuspState = SuspensionData[WheelIdx];
+
+		// Ground under the wheel is somewhere between its neighbors on the track
+		float NeighborsLength = 0.f;
+		int32 NeighborsNum = 0;
+		for (const FSuspensionState* Neighbor : {FindTrackNeighbor(WheelIdx, -1), FindTrackNeighbor(WheelIdx, 1)})
+		{
+			if (Neighbor)
+			{
+				NeighborsLength += Neighbor->SampledLength;
+				NeighborsNum++;
+			}
+		}
+
+		float TargetLength = SuspState.SampledLength;
+		if (NeighborsNum > 0)
+		{
+			TargetLength = FMath::Lerp(SuspState.SampledLength, NeighborsLength / NeighborsNum, 0.5f);
+		}
+
+		TargetLength = FMath::Clamp(TargetLength, 0.f, SuspState.SuspensionInfo.Length + SuspState.SuspensionInfo.MaxDrop);
+
+		if (SuspState.VisualLength < TargetLength)
+		{
+			SuspState.VisualLength = FMath::Lerp(SuspState.VisualLength, TargetLength, FMath::Clamp(DeltaTime * DropFactor, 0.f, 1.f));
+		}
+		else
+		{
+			SuspState.VisualLength = TargetLength;
+		}
 	}
 }
 
-void UPrvVehicleMovementComponent::UpdateSuspensionVisualsOnly(float DeltaTime)
+int32 UPrvVehicleMovementComponent::GetVisualsOnlyProbeDivisor() const
 {
-	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateSuspensionVisualsOnly);
+	return FMath::Max(1, (GPrvVehicleVisualsOnlyProbeDivisor > 0) ? GPrvVehicleVisualsOnlyProbeDivisor : VisualsOnlyProbeDivisor);
+}
 
-	// Suspension
-	if (bShouldAnimateWheels)
+//////////////////////////////////////////////////////////////////////////
+// Suspension probes
+
+void UPrvVehicleMovementComponent::MakeWheelProbe(const FSuspensionState& SuspState, const FTransform& MeshTransform, bool bUseLineTrace, FPrvWheelProbe& OutProbe) const
+{
+	OutProbe.MeshTransform = MeshTransform;
+
+	OutProbe.UpVector = MeshTransform.TransformVectorNoScale(UKismetMathLibrary::GetUpVector(SuspState.SuspensionInfo.Rotation));
+	OutProbe.Start = MeshTransform.TransformPosition(SuspState.SuspensionInfo.Location);
+	OutProbe.End = OutProbe.Start - OutProbe.UpVector * (SuspState.SuspensionInfo.Length + SuspState.SuspensionInfo.MaxDrop);
+	OutProbe.Radius = SuspState.SuspensionInfo.CollisionRadius;
+	OutProbe.bLineTrace = bUseLineTrace;
+
+	// For cylindrical wheels only
+	OutProbe.bCylinder = FMath::Abs(DefaultCollisionWidth) > SMALL_NUMBER && !bUseLineTrace;
+	OutProbe.bBoxSweep = OutProbe.bCylinder && SuspState.SuspensionInfo.CollisionWidth > SMALL_NUMBER && GPrvVehicleLegacyCylinderTrace == 0;
+	OutProbe.Rotation = MeshTransform.GetRotation() * SuspState.SuspensionInfo.Rotation.Quaternion();
+	OutProbe.HalfWidth = FMath::Max(0.f, SuspState.SuspensionInfo.CollisionWidth) / 2.f;
+}
+
+void UPrvVehicleMovementComponent::MakeProbeRequest(const FPrvWheelProbe& Probe, FPrvProbeRequest& OutRequest) const
+{
+	OutRequest.Channel = SuspensionTraceChannel;
+	OutRequest.QueryParams = SuspensionQueryParams;
+	OutRequest.ResponseParams = SuspensionResponseParams;
+	OutRequest.Rotation = FQuat::Identity;
+
+	if (Probe.bLineTrace)
+	{
+		const FVector RadiusUpVector = Probe.UpVector * Probe.Radius;
+
+		OutRequest.Start = Probe.Start + RadiusUpVector;
+		OutRequest.End = Probe.End - RadiusUpVector;
+		OutRequest.Shape = FCollisionShape::LineShape;
+		OutRequest.TraceType = EAsyncTraceType::Single;
+	}
+	else
+	{
+		OutRequest.Start = Probe.Start;
+		OutRequest.End = Probe.End;
+		OutRequest.Rotation = Probe.GetShapeRotation();
+		OutRequest.Shape = Probe.GetShape();
+		OutRequest.TraceType = (Probe.bCylinder && !Probe.bBoxSweep) ? EAsyncTraceType::Multi : EAsyncTraceType::Single;
+	}
+}
+
+bool UPrvVehicleMovementComponent::TraceWheel(FSuspensionState& SuspState, const FPrvWheelProbe& Probe, FHitResult& OutHit, bool& bOutHitValid)
+{
+	bool bHit = false;
+	bool bHasResult = false;
+	bOutHitValid = false;
+
+	// Trace settings can be changed at runtime
+	if (SuspensionQueryParams.bTraceComplex != bTraceComplex || CachedSuspensionTraceTypeQuery != SuspensionTraceTypeQuery)
+	{
+		InitSuspensionQueryParams();
+	}
+
+	// Wheel hasn't moved since last probe
+	if (ReuseCoherentHit(SuspState, Probe, OutHit, bOutHitValid))
+	{
+		SuspState.ProbeTicket.Invalidate();
+
+		INC_DWORD_STAT(STAT_PrvMovementSuspensionProbesSkipped);
+		return bOutHitValid;
+	}
+
+	INC_DWORD_STAT(STAT_PrvMovementSuspensionProbesIssued);
+
+	// Road wheels are put on the track ground profile
+	if (TraceWheelTrackProfile(SuspState, Probe, OutHit, bOutHitValid))
+	{
+		bHit = bOutHitValid;
+		bHasResult = true;
+	}
+
+	// Later fixed steps of the frame have the probe queued already, and its results will come on the next frame
+	const bool bProbeQueuedThisFrame = SuspState.ProbeTicket.IsValid() && SuspState.ProbeTicket.FrameNumber == GFrameCounter;
+
+	// Take results of the probe queued on the previous tick and queue the next one
+	UPrvVehicleSubsystem* ProbeService = (UseAsyncTrace() && !bHasResult && !bProbeQueuedThisFrame) ? GetWorld()->GetSubsystem<UPrvVehicleSubsystem>() : nullptr;
+	if (ProbeService)
+	{
+		TArray<FHitResult> Hits;
+		if (SuspState.bProbeTicketLineTrace == Probe.bLineTrace && ProbeService->GetProbeResult(SuspState.ProbeTicket, Hits))
+		{
+			bHit = ResolveWheelHits(SuspState, Probe, Hits, OutHit, bOutHitValid);
+			bHasResult = true;
+
+			// Suspension has moved since the probe was made: project contact onto current suspension axis
+			if (bOutHitValid && !Probe.bLineTrace && !OutHit.bStartPenetrating)
+			{
+				OutHit.Distance = FMath::Max(0.f, FVector::DotProduct(Probe.Start - OutHit.Location, Probe.UpVector));
+				OutHit.Location = Probe.Start - Probe.UpVector * OutHit.Distance;
+			}
+		}
+
+		FPrvProbeRequest Request;
+		MakeProbeRequest(Probe, Request);
+		SuspState.ProbeTicket = ProbeService->RequestProbe(Request);
+		SuspState.bProbeTicketLineTrace = Probe.bLineTrace;
+	}
+	else if (!bProbeQueuedThisFrame)
+	{
+		SuspState.ProbeTicket.Invalidate();
+	}
+
+	// Synchronous trace when there are no async results (first tick, after sleep, or async is disabled)
+	if (!bHasResult)
+	{
+		bHit = TraceWheelSync(SuspState, Probe, OutHit, bOutHitValid);
+	}
+
+	// Conver line hit to "sphere" hit
+	if (Probe.bLineTrace && bOutHitValid)
+	{
+		OutHit.Location = OutHit.ImpactPoint + Probe.UpVector * Probe.Radius;
+		OutHit.Distance = (OutHit.Location - Probe.Start).Size();
+	}
+
+	// Additional check that hit is valid (for non-spherical wheel)
+	if (bOutHitValid)
+	{
+		// Transform impact point to actor space
+		const FVector HitActorLocation = Probe.MeshTransform.InverseTransformPosition(OutHit.ImpactPoint);
+
+		// Check that collision is under suspension
+		if (HitActorLocation.Z >= SuspState.SuspensionInfo.Location.Z)
+		{
+			if (bDebugSuspensionLimits)
+			{
+				UE_LOG(LogPrvVehicle, Warning, TEXT("Susp Hit Forced to Zero: Collision.Z: %f, Suspension.Z: %f"), HitActorLocation.Z, SuspState.SuspensionInfo.Location.Z);
+			}
+
+			// Force maximum compression
+			OutHit.ImpactPoint = Probe.Start;
+			OutHit.ImpactNormal = Probe.UpVector;
+			OutHit.Distance = 0.f;
+		}
+	}
+
+	CacheCoherentHit(SuspState, Probe, OutHit, bOutHitValid);
+
+	SuspState.LastHitComponent = bOutHitValid ? OutHit.Component : TWeakObjectPtr<UPrimitiveComponent>();
+
+	return bHit;
+}
+
+bool UPrvVehicleMovementComponent::UpdateSuspensionBroadphase(const FPrvBodySnapshot& Body, bool bUseLineTrace)
+{
+	BroadphaseComponents.Reset();
+	bBroadphaseLandscapeOnly = false;
+	BroadphaseGroundGrid = nullptr;
+
+	const bool bUseBroadphase = (bSuspensionBroadphase && GPrvVehicleSuspensionBroadphase != 0) || UseLandscapeGround() || UseBakedGround();
+	if (!bUseBroadphase || SuspensionData.Num() == 0)
+	{
+		return false;
+	}
+
+	PRV_CYCLE_COUNTER(STAT_PrvMovementSuspensionBroadphase);
+
+	// Trace settings can be changed at runtime
+	if (SuspensionQueryParams.bTraceComplex != bTraceComplex || CachedSuspensionTraceTypeQuery != SuspensionTraceTypeQuery)
+	{
+		InitSuspensionQueryParams();
+	}
+
+	// Mesh space bounds of all wheel probes
+	FBox SuspensionBounds(ForceInit);
+	for (const FSuspensionState& SuspState : SuspensionData)
+	{
+		const FSuspensionInfo& SuspInfo = SuspState.SuspensionInfo;
+		const FVector SuspDown = -UKismetMathLibrary::GetUpVector(SuspInfo.Rotation) * (SuspInfo.Length + SuspInfo.MaxDrop + (bUseLineTrace ? SuspInfo.CollisionRadius : 0.f));
+		const float WheelExtent = SuspInfo.CollisionRadius + FMath::Max(0.f, SuspInfo.CollisionWidth) / 2.f;
+
+		SuspensionBounds += FBox::BuildAABB(SuspInfo.Location, FVector(WheelExtent));
+		SuspensionBounds += FBox::BuildAABB(SuspInfo.Location + SuspDown, FVector(WheelExtent));
+	}
+
+	// Vehicle could move a bit while forces are applied
+	const FTransform& MeshTransform = Body.ComponentTransform;
+	const FVector Extent = SuspensionBounds.GetExtent() + FVector(Body.LinearVelocity.Size() * GetWorld()->GetDeltaSeconds());
+
+	TArray<FOverlapResult> Overlaps;
+	GetWorld()->OverlapMultiByChannel(Overlaps, MeshTransform.TransformPosition(SuspensionBounds.GetCenter()), MeshTransform.GetRotation(), SuspensionTraceChannel, FCollisionShape::MakeBox(Extent), SuspensionQueryParams, SuspensionResponseParams);
+
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		UPrimitiveComponent* Component = Overlap.GetComponent();
+		if (Component && Component->GetCollisionResponseToChannel(SuspensionTraceChannel) == ECR_Block)
+		{
+			BroadphaseComponents.AddUnique(Component);
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_PrvMovementSuspensionBroadphasePrimitives, BroadphaseComponents.Num());
+
+	// Baked ground is valid only while there is no dynamic geometry around
+	UPrvVehicleSubsystem* VehicleSubsystem = UseBakedGround() ? GetWorld()->GetSubsystem<UPrvVehicleSubsystem>() : nullptr;
+	if (VehicleSubsystem)
+	{
+		BroadphaseGroundGrid = VehicleSubsystem->GetGroundGrid();
+		for (const UPrimitiveComponent* Component : BroadphaseComponents)
+		{
+			if (Component->Mobility != EComponentMobility::Static)
+			{
+				BroadphaseGroundGrid = nullptr;
+				break;
+			}
+		}
+	}
+
+	// Nothing but landscape under the vehicle
+	bBroadphaseLandscapeOnly = UseLandscapeGround() && BroadphaseComponents.Num() > 0;
+	for (const UPrimitiveComponent* Component : BroadphaseComponents)
+	{
+		if (!Component->IsA<ULandscapeHeightfieldCollisionComponent>())
+		{
+			bBroadphaseLandscapeOnly = false;
+			break;
+		}
+	}
+
+	if (IsDebug())
+	{
+		DrawDebugBox(GetWorld(), MeshTransform.TransformPosition(SuspensionBounds.GetCenter()), Extent, MeshTransform.GetRotation(), FColor::Orange, false, /*LifeTime*/ 0.f);
+	}
+
+	return true;
+}
+
+bool UPrvVehicleMovementComponent::TraceWheelNarrowphase(const FSuspensionState& SuspState, const FPrvWheelProbe& Probe, TArrayView<UPrimitiveComponent* const> Components, FHitResult& OutHit, bool& bOutHitValid)
+{
+	FVector TraceStart = Probe.Start;
+	FVector TraceEnd = Probe.End;
+	if (Probe.bLineTrace)
+	{
+		const FVector RadiusUpVector = Probe.UpVector * Probe.Radius;
+		TraceStart += RadiusUpVector;
+		TraceEnd -= RadiusUpVector;
+	}
+
+	const FCollisionShape WheelShape = Probe.GetShape();
+	const FQuat WheelShapeRotation = Probe.GetShapeRotation();
+
+	TArray<FHitResult> Hits;
+	for (UPrimitiveComponent* Component : Components)
+	{
+		if (!IsValid(Component))
+		{
+			continue;
+		}
+
+		FHitResult ComponentHit;
+		const bool bComponentHit = Probe.bLineTrace
+			? Component->LineTraceComponent(ComponentHit, TraceStart, TraceEnd, SuspensionQueryParams)
+			: Component->SweepComponent(ComponentHit, TraceStart, TraceEnd, WheelShapeRotation, WheelShape, bTraceComplex);
+
+		if (bComponentHit)
+		{
+			// Component queries don't fill query specific data
+			ComponentHit.bBlockingHit = true;
+			ComponentHit.TraceStart = TraceStart;
+			ComponentHit.TraceEnd = TraceEnd;
+			ULandscapeHeightfieldCollisionComponent* LandscapeComponent = Cast<ULandscapeHeightfieldCollisionComponent>(Component);
+			if (!ComponentHit.PhysMaterial.IsValid() && LandscapeComponent)
+			{
+				ComponentHit.PhysMaterial = FPrvGroundProbe::GetLandscapePhysicalMaterial(LandscapeComponent, ComponentHit.ImpactPoint);
+			}
+			else if (!ComponentHit.PhysMaterial.IsValid())
+			{
+				const FBodyInstance* BodyInstance = Component->GetBodyInstance(ComponentHit.BoneName);
+				ComponentHit.PhysMaterial = BodyInstance ? BodyInstance->GetSimplePhysicalMaterial() : nullptr;
+			}
+
+			Hits.Add(ComponentHit);
+		}
+	}
+
+	// Nearest hit goes first as in scene queries
+	Hits.Sort([](const FHitResult& A, const FHitResult& B) { return A.Distance < B.Distance; });
+
+	const bool bHit = ResolveWheelHits(SuspState, Probe, Hits, OutHit, bOutHitValid);
+
+	if (IsDebug())
+	{
+		DrawDebugLine(GetWorld(), TraceStart, bOutHitValid ? OutHit.Location : TraceEnd, bOutHitValid ? FColor::Red : FColor::Green, false, /*LifeTime*/ 0.f);
+	}
+
+	return bHit;
+}
+
+bool UPrvVehicleMovementComponent::TraceWheelLandscape(const FSuspensionState& SuspState, const FPrvWheelProbe& Probe, FHitResult& OutHit, bool& bOutHitValid)
+{
+	for (UPrimitiveComponent* Component : BroadphaseComponents)
+	{
+		ULandscapeHeightfieldCollisionComponent* LandscapeComponent = Cast<ULandscapeHeightfieldCollisionComponent>(Component);
+		if (LandscapeComponent == nullptr)
+		{
+			continue;
+		}
+
+		// Probe start should be over the component
+		const FBox ComponentBox = LandscapeComponent->Bounds.GetBox();
+		if (Probe.Start.X < ComponentBox.Min.X || Probe.Start.X > ComponentBox.Max.X || Probe.Start.Y < ComponentBox.Min.Y || Probe.Start.Y > ComponentBox.Max.Y)
+		{
+			continue;
+		}
+
+		FHitResult LandscapeHit;
+		if (FPrvGroundProbe::TraceLandscape(LandscapeComponent, Probe, bTraceComplex, LandscapeHit))
+		{
+			INC_DWORD_STAT(STAT_PrvMovementSuspensionLandscapeProbes);
+
+			// Landscape is the only ground here, so its result is final even if wheel misses it
+			ResolveWheelHits(SuspState, Probe, MakeArrayView(&LandscapeHit, 1), OutHit, bOutHitValid);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool UPrvVehicleMovementComponent::UseLandscapeGround() const
+{
+	return bLandscapeGround && (GPrvVehicleLandscapeGround != 0);
+}
+
+bool UPrvVehicleMovementComponent::UpdateTrackProfiles(const FTransform& MeshTransform)
+{
+	TrackProfiles[0].bActive = false;
+	TrackProfiles[1].bActive = false;
+
+	if (!UseTrackProfile())
+	{
+		return false;
+	}
+
+	const FVector MeshUpVector = MeshTransform.GetUnitAxis(EAxis::Z);
+	const int32 SamplesNum = FMath::Max(2, TrackProfileSamples);
+
+	for (int32 TrackIdx = 0; TrackIdx < 2; ++TrackIdx)
+	{
+		FPrvTrackProfile& Profile = TrackProfiles[TrackIdx];
+
+		// Mesh space extent of the track
+		float TrackY = 0.f;
+		float TopZ = -BIG_NUMBER;
+		float BottomZ = BIG_NUMBER;
+		int32 WheelsNum = 0;
+		Profile.MinX = BIG_NUMBER;
+		Profile.MaxX = -BIG_NUMBER;
+
+		for (const FSuspensionState& SuspState : SuspensionData)
+		{
+			const FSuspensionInfo& SuspInfo = SuspState.SuspensionInfo;
+			if (SuspInfo.bRightTrack != (TrackIdx == 1))
+			{
+				continue;
+			}
+
+			Profile.MinX = FMath::Min(Profile.MinX, SuspInfo.Location.X);
+			Profile.MaxX = FMath::Max(Profile.MaxX, SuspInfo.Location.X);
+			TopZ = FMath::Max(TopZ, SuspInfo.Location.Z);
+			BottomZ = FMath::Min(BottomZ, SuspInfo.Location.Z - SuspInfo.Length - SuspInfo.MaxDrop - SuspInfo.CollisionRadius * 2.f);
+			TrackY += SuspInfo.Location.Y;
+			WheelsNum++;
+		}
+
+		// Profile makes sense only when it's cheaper than per wheel probes
+		if (WheelsNum <= SamplesNum)
+		{
+			continue;
+		}
+
+		TrackY /= WheelsNum;
+
+		Profile.Points.SetNum(SamplesNum);
+		Profile.Normals.SetNum(SamplesNum);
+		Profile.ValidSamples.SetNum(SamplesNum);
+		Profile.Components.SetNum(SamplesNum);
+		Profile.PhysMaterials.SetNum(SamplesNum);
+
+		for (int32 SampleIdx = 0; SampleIdx < SamplesNum; ++SampleIdx)
+		{
+			const float SampleX = FMath::Lerp(Profile.MinX, Profile.MaxX, static_cast<float>(SampleIdx) / (SamplesNum - 1));
+			const FVector TraceStart = MeshTransform.TransformPosition(FVector(SampleX, TrackY, TopZ));
+			const FVector TraceEnd = TraceStart - MeshUpVector * (TopZ - BottomZ);
+
+			FHitResult Hit;
+			Profile.ValidSamples[SampleIdx] = GetWorld()->LineTraceSingleByChannel(Hit, TraceStart, TraceEnd, SuspensionTraceChannel, SuspensionQueryParams, SuspensionResponseParams);
+			Profile.Points[SampleIdx] = Hit.ImpactPoint;
+			Profile.Normals[SampleIdx] = Hit.ImpactNormal;
+			Profile.Components[SampleIdx] = Hit.Component;
+			Profile.PhysMaterials[SampleIdx] = Hit.PhysMaterial;
+
+			if (IsDebug())
+			{
+				DrawDebugLine(GetWorld(), TraceStart, Profile.ValidSamples[SampleIdx] ? Hit.ImpactPoint : TraceEnd, FColor::Yellow, false, /*LifeTime*/ 0.f, 0, 2.f);
+			}
+		}
+
+		INC_DWORD_STAT_BY(STAT_PrvMovementSuspensionTrackProfileProbes, SamplesNum);
+
+		Profile.bActive = true;
+	}
+
+	return TrackProfiles[0].bActive || TrackProfiles[1].bActive;
+}
+
+bool UPrvVehicleMovementComponent::TraceWheelTrackProfile(const FSuspensionState& SuspState, const FPrvWheelProbe& Probe, FHitResult& OutHit, bool& bOutHitValid) const
+{
+	const FPrvTrackProfile& Profile = TrackProfiles[SuspState.SuspensionInfo.bRightTrack ? 1 : 0];
+	if (!Profile.bActive)
+	{
+		return false;
+	}
+
+	// Find the profile segment under the wheel
+	const int32 SegmentsNum = Profile.Points.Num() - 1;
+	const float TrackLength = Profile.MaxX - Profile.MinX;
+	const float SegmentPosition = (TrackLength > KINDA_SMALL_NUMBER) ? FMath::Clamp((SuspState.SuspensionInfo.Location.X - Profile.MinX) / TrackLength, 0.f, 1.f) * SegmentsNum : 0.f;
+	const int32 SegmentIdx = FMath::Min(FMath::FloorToInt(SegmentPosition), SegmentsNum - 1);
+	const float SegmentAlpha = SegmentPosition - SegmentIdx;
+
+	// Track is in the air or over a hole: wheel should find the ground itself
+	if (!Profile.ValidSamples[SegmentIdx] || !Profile.ValidSamples[SegmentIdx + 1])
+	{
+		return false;
+	}
+
+	const FVector GroundPoint = FMath::Lerp(Profile.Points[SegmentIdx], Profile.Points[SegmentIdx + 1], SegmentAlpha);
+	const FVector GroundNormal = FMath::Lerp(Profile.Normals[SegmentIdx], Profile.Normals[SegmentIdx + 1], SegmentAlpha).GetSafeNormal();
+
+	bOutHitValid = FPrvGroundProbe::MakePlaneHit(Probe, GroundPoint, GroundNormal, OutHit);
+	if (bOutHitValid)
+	{
+		// Nearest sample gives the ground object
+		const int32 NearestIdx = (SegmentAlpha < 0.5f) ? SegmentIdx : SegmentIdx + 1;
+		OutHit.Component = Profile.Components[NearestIdx];
+		OutHit.Actor = OutHit.Component.IsValid() ? OutHit.Component->GetOwner() : nullptr;
+		OutHit.PhysMaterial = Profile.PhysMaterials[NearestIdx];
+	}
+
+	return true;
+}
+
+bool UPrvVehicleMovementComponent::UseTrackProfile() const
+{
+	return bTrackGroundProfile && !bWheeledVehicle && (GPrvVehicleTrackGroundProfile != 0);
+}
+
+bool UPrvVehicleMovementComponent::TraceWheelBakedGround(const FSuspensionState& SuspState, const FPrvWheelProbe& Probe, FHitResult& OutHit, bool& bOutHitValid)
+{
+	FVector GroundPoint, GroundNormal;
+	uint8 SurfaceType = 0;
+	UPhysicalMaterial* PhysMaterial = nullptr;
+
+	// Grid has no data here (out of baked area or no ground at all)
+	if (!BroadphaseGroundGrid->Sample(Probe.Start, GroundPoint, GroundNormal, SurfaceType, PhysMaterial))
+	{
+		return false;
+	}
+
+	INC_DWORD_STAT(STAT_PrvMovementSuspensionBakedGroundProbes);
+
+	FHitResult GroundHit;
+	if (!FPrvGroundProbe::MakePlaneHit(Probe, GroundPoint, GroundNormal, GroundHit))
+	{
+		bOutHitValid = false;
+		return true;
+	}
+
+	// Refine with the cell under the contact point
+	if (BroadphaseGroundGrid->Sample(GroundHit.ImpactPoint + GroundNormal * SuspState.SuspensionInfo.Length, GroundPoint, GroundNormal, SurfaceType, PhysMaterial) &&
+		!FPrvGroundProbe::MakePlaneHit(Probe, GroundPoint, GroundNormal, GroundHit))
+	{
+		bOutHitValid = false;
+		return true;
+	}
+
+	// Baked ground has no primitive, so its hits keep cell surface type as item data
+	GroundHit.PhysMaterial = PhysMaterial;
+	GroundHit.Item = SurfaceType;
+
+	ResolveWheelHits(SuspState, Probe, MakeArrayView(&GroundHit, 1), OutHit, bOutHitValid);
+	return true;
+}
+
+bool UPrvVehicleMovementComponent::UseBakedGround() const
+{
+	return bBakedGround && (GPrvVehicleBakedGround == 2 || (GPrvVehicleBakedGround == 1 && IsNetMode(NM_DedicatedServer)));
+}
+
+EPhysicalSurface UPrvVehicleMovementComponent::GetWheelSurfaceType(const FHitResult& Hit)
+{
+	if (Hit.PhysMaterial.IsValid() || Hit.Component.IsValid())
+	{
+		return UGameplayStatics::GetSurfaceType(Hit);
+	}
+
+	// Baked ground cell without physical material
+	if (Hit.Item > 0 && Hit.Item < SurfaceType_Max)
+	{
+		return static_cast<EPhysicalSurface>(Hit.Item);
+	}
+
+	return EPhysicalSurface::SurfaceType_Default;
+}
+
+bool UPrvVehicleMovementComponent::TraceWheelLastContact(const FSuspensionState& SuspState, const FPrvWheelProbe& Probe, FHitResult& OutHit, bool& bOutHitValid)
+{
+	UPrimitiveComponent* LastComponent = SuspState.LastHitComponent.Get();
+	if (GPrvVehicleSuspensionContactReuse == 0 || LastComponent == nullptr)
+	{
+		return false;
+	}
+
+	// Wheel should be well inside the primitive bounds, otherwise it can touch something else
+	const float WheelExtent = Probe.Radius + FMath::Max(0.f, SuspState.SuspensionInfo.CollisionWidth) / 2.f;
+	FBox ProbeBounds = FBox::BuildAABB(Probe.Start, FVector(WheelExtent));
+	ProbeBounds += FBox::BuildAABB(Probe.End - (Probe.bLineTrace ? Probe.UpVector * Probe.Radius : FVector::ZeroVector), FVector(WheelExtent));
+
+	if (!LastComponent->Bounds.GetBox().IsInside(ProbeBounds))
+	{
+		INC_DWORD_STAT(STAT_PrvMovementSuspensionLastContactMisses);
+		return false;
+	}
+
+	UPrimitiveComponent* const Components[] = {LastComponent};
+	TraceWheelNarrowphase(SuspState, Probe, Components, OutHit, bOutHitValid);
+
+	if (!bOutHitValid)
+	{
+		INC_DWORD_STAT(STAT_PrvMovementSuspensionLastContactMisses);
+		return false;
+	}
+
+	INC_DWORD_STAT(STAT_PrvMovementSuspensionLastContactHits);
+	return true;
+}
+
+bool UPrvVehicleMovementComponent::ReuseCoherentHit(FSuspensionState& SuspState, const FPrvWheelProbe& Probe, FHitResult& OutHit, bool& bOutHitValid) const
+{
+	if (!SuspState.bCoherentHitValid)
+	{
+		return false;
+	}
+
+	if (!bSuspensionCoherence || GPrvVehicleSuspensionCoherence == 0 || SuspState.bCoherentLineTrace != Probe.bLineTrace || SuspState.CoherentFramesLeft <= 0)
+	{
+		SuspState.bCoherentHitValid = false;
+		return false;
+	}
+
+	// Probe should stay in place: compare both ends to catch rotation too
+	const FVector ProbeOffset = Probe.UpVector * (SuspState.SuspensionInfo.Length + SuspState.SuspensionInfo.MaxDrop);
+	const FVector CoherentProbeOffset = SuspState.CoherentProbeUpVector * (SuspState.SuspensionInfo.Length + SuspState.SuspensionInfo.MaxDrop);
+	const float MaxDistanceSquared = FMath::Square(SuspensionCoherenceDistance);
+	if (FVector::DistSquared(Probe.Start, SuspState.CoherentProbeStart) > MaxDistanceSquared ||
+		FVector::DistSquared(Probe.Start - ProbeOffset, SuspState.CoherentProbeStart - CoherentProbeOffset) > MaxDistanceSquared)
+	{
+		SuspState.bCoherentHitValid = false;
+		return false;
+	}
+
+	// Ground could be moved or destroyed
+	const UPrimitiveComponent* HitComponent = SuspState.CoherentHit.Component.Get();
+	if (HitComponent == nullptr || HitComponent->Mobility != EComponentMobility::Static)
+	{
+		SuspState.bCoherentHitValid = false;
+		return false;
+	}
+
+	SuspState.CoherentFramesLeft--;
+
+	OutHit = SuspState.CoherentHit;
+	bOutHitValid = true;
+	return true;
+}
+
+void UPrvVehicleMovementComponent::CacheCoherentHit(FSuspensionState& SuspState, const FPrvWheelProbe& Probe, const FHitResult& Hit, bool bHitValid) const
+{
+	// Only contacts with static geometry can be reused
+	const UPrimitiveComponent* HitComponent = bHitValid ? Hit.Component.Get() : nullptr;
+	if (!bSuspensionCoherence || GPrvVehicleSuspensionCoherence == 0 || HitComponent == nullptr || HitComponent->Mobility != EComponentMobility::Static)
+	{
+		SuspState.bCoherentHitValid = false;
+		return;
+	}
+
+	SuspState.CoherentHit = Hit;
+	SuspState.CoherentProbeStart = Probe.Start;
+	SuspState.CoherentProbeUpVector = Probe.UpVector;
+	SuspState.CoherentFramesLeft = FMath::Max(1, SuspensionCoherenceFrames);
+	SuspState.bCoherentHitValid = true;
+	SuspState.bCoherentLineTrace = Probe.bLineTrace;
+}
+
+bool UPrvVehicleMovementComponent::CorrectBoxSweepHit(const FPrvWheelProbe& Probe, FHitResult& InOutHit) const
+{
+	if (InOutHit.bStartPenetrating)
 	{
-		TArray<AActor*> IgnoredActors;
-		EDrawDebugTrace::Type DebugType = IsDebug() ? EDrawDebugTrace::ForOneFrame : EDrawDebugTrace::None;
+		return true;
+	}
+
+	const FVector& GroundNormal = InOutHit.ImpactNormal;
+	const float Approach = FVector::DotProduct(Probe.UpVector, GroundNormal);
+	if (Approach <= KINDA_SMALL_NUMBER)
+	{
+		return true;
+	}
+
+	// Support distances of the box and the inscribed cylinder (axis is wheel Y) along the ground normal
+	const float NormalX = FMath::Abs(FVector::DotProduct(GroundNormal, Probe.Rotation.GetAxisX()));
+	const float NormalY = FMath::Abs(FVector::DotProduct(GroundNormal, Probe.Rotation.GetAxisY()));
+	const float NormalZ = FMath::Abs(FVector::DotProduct(GroundNormal, Probe.Rotation.GetAxisZ()));
+	const float BoxSupport = Probe.Radius * (NormalX + NormalZ) + Probe.HalfWidth * NormalY;
+	const float CylinderSupport = Probe.Radius * FMath::Sqrt(FMath::Max(0.f, 1.f - NormalY * NormalY)) + Probe.HalfWidth * NormalY;
+
+	// Box corners touch the ground plane earlier than the cylinder does
+	const float Distance = InOutHit.Distance + (BoxSupport - CylinderSupport) / Approach;
+	if (Distance > (Probe.End - Probe.Start).Size())
+	{
+		return false;
+	}
+
+	InOutHit.Distance = Distance;
+	InOutHit.Location = Probe.Start - Probe.UpVector * Distance;
+	InOutHit.ImpactPoint = InOutHit.Location - GroundNormal * CylinderSupport;
+
+	return true;
+}
 
-		// For simulated proxy, suspension use line trace
-		bool bUseLineTrace = UseLineTrace();
+bool UPrvVehicleMovementComponent::ResolveWheelHits(const FSuspensionState& SuspState, const FPrvWheelProbe& Probe, TArrayView<const FHitResult> Hits, FHitResult& OutHit, bool& bOutHitValid) const
+{
+	bool bHit = false;
+	bOutHitValid = false;
 
-		if (!bUseLineTrace && bSimplifiedSuspensionByCamera)
+	if (!Probe.bCylinder || Probe.bBoxSweep)
+	{
+		for (const FHitResult& MyHit : Hits)
 		{
-			FVector RelativeCameraVector;
-			FVector RelativeMeshForwardVector;
-			if (GetCameraVector(RelativeCameraVector, RelativeMeshForwardVector))
+			if (MyHit.bBlockingHit)
 			{
-				RelativeCameraVector.Z = 0;
-				if (RelativeCameraVector.SizeSquared() > SMALL_NUMBER)
-				{
-					RelativeCameraVector.Normalize();
-					if (FMath::Abs(RelativeCameraVector | RelativeMeshForwardVector) > 0.9f)
-					{
-						bUseLineTrace = true;
-					}
-				}
+				OutHit = MyHit;
+				bOutHitValid = !Probe.bBoxSweep || CorrectBoxSweepHit(Probe, OutHit);
+				return true;
 			}
 		}
 
-		for (auto& SuspState : SuspensionData)
-		{
-			const FVector SuspUpVector = UpdatedMesh->GetComponentTransform().TransformVectorNoScale(UKismetMathLibrary::GetUpVector(SuspState.SuspensionInfo.Rotation));
-			const FVector SuspWorldLocation = UpdatedMesh->GetComponentTransform().TransformPosition(SuspState.SuspensionInfo.Location);
-			const FVector SuspTraceEndLocation = SuspWorldLocation - SuspUpVector * (SuspState.SuspensionInfo.Length + SuspState.SuspensionInfo.MaxDrop);
-			const FVector RadiusUpVector = SuspUpVector * SuspState.SuspensionInfo.CollisionRadius;
-
-			// Make trace to touch the ground
-			FHitResult Hit;
-			bool bHit = false;
-			bool bHitValid = false;
+		return false;
+	}
 
-			// For cylindrical wheels only
-			if (FMath::Abs(DefaultCollisionWidth) > SMALL_NUMBER && !bUseLineTrace)
-			{
-				TArray<FHitResult> Hits;
+	// Process hits and find the best one
+	const FTransform& MeshTransform = Probe.MeshTransform;
+	float BestDistanceSquared = MAX_FLT;
+	for (const FHitResult& MyHit : Hits)
+	{
+		// Ignore overlap
+		if (!MyHit.bBlockingHit)
+		{
+			continue;
+		}
 
-#if ENGINE_MINOR_VERSION >= 15
-				bHit = UKismetSystemLibrary::SphereTraceMulti(this, SuspWorldLocation, SuspTraceEndLocation, SuspState.SuspensionInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hits, true);
-#else
-				bHit = UKismetSystemLibrary::SphereTraceMulti_NEW(this, SuspWorldLocation, SuspTraceEndLocation, SuspState.SuspensionInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hits, true);
-#endif
+		bHit = true;
 
-				// Process hits and find the best one
-				float BestDistanceSquared = MAX_FLT;
-				for (auto MyHit : Hits)
-				{
-					// Ignore overlap
-					if (!MyHit.bBlockingHit)
-					{
-						continue;
-					}
+		FVector HitLocation_SuspSpace = FVector::ZeroVector;
 
-					FVector HitLocation_SuspSpace = FVector::ZeroVector;
+		// Check that it was penetration hit
+		if (MyHit.bStartPenetrating)
+		{
+			HitLocation_SuspSpace = (MyHit.PenetrationDepth - SuspState.SuspensionInfo.CollisionRadius) * MeshTransform.InverseTransformVectorNoScale(MyHit.Normal);
+		}
+		else
+		{
+			// Transform into wheel space
+			HitLocation_SuspSpace = MeshTransform.InverseTransformPosition(MyHit.ImpactPoint) - SuspState.SuspensionInfo.Location;
+		}
 
-					// Check that it was penetration hit
-					if (MyHit.bStartPenetrating)
-					{
-						HitLocation_SuspSpace = (MyHit.PenetrationDepth - SuspState.SuspensionInfo.CollisionRadius) * UpdatedMesh->GetComponentTransform().InverseTransformVectorNoScale(MyHit.Normal);
-					}
-					else
-					{
-						// Transform into wheel space
-						HitLocation_SuspSpace = UpdatedMesh->GetComponentTransform().InverseTransformPosition(MyHit.ImpactPoint) - SuspState.SuspensionInfo.Location;
-					}
+		// Apply reverse wheel rotation
+		HitLocation_SuspSpace = SuspState.SuspensionInfo.Rotation.UnrotateVector(HitLocation_SuspSpace);
 
-					// Apply reverse wheel rotation
-					HitLocation_SuspSpace = SuspState.SuspensionInfo.Rotation.UnrotateVector(HitLocation_SuspSpace);
+		// Check that is outside the cylinder
+		if (FMath::Abs(HitLocation_SuspSpace.Y) < (SuspState.SuspensionInfo.CollisionWidth / 2.f))
+		{
+			// Select the nearest one
+			if (HitLocation_SuspSpace.SizeSquared() < BestDistanceSquared)
+			{
+				BestDistanceSquared = HitLocation_SuspSpace.SizeSquared();
 
-					// Check that is outside the cylinder
-					if (FMath::Abs(HitLocation_SuspSpace.Y) < (SuspState.SuspensionInfo.CollisionWidth / 2.f))
-					{
-						// Select the nearest one
-						if (HitLocation_SuspSpace.SizeSquared() < BestDistanceSquared)
-						{
-							BestDistanceSquared = HitLocation_SuspSpace.SizeSquared();
+				OutHit = MyHit;
+				bOutHitValid = true;
+			}
+		}
 
-							Hit = MyHit;
-							bHitValid = true;
-						}
-					}
+		// Debug hit points
+		if (bShowDebug)
+		{
+			DrawDebugPoint(GetWorld(), MeshTransform.TransformPosition(SuspState.SuspensionInfo.Location + SuspState.SuspensionInfo.Rotation.RotateVector(HitLocation_SuspSpace)), 5.f, FColor::Green, false, /*LifeTime*/ 0.f);
+		}
+	}
 
-					// Debug hit points
-					if (bShowDebug)
-					{
-						DrawDebugPoint(GetWorld(), UpdatedMesh->GetComponentTransform().TransformPosition(SuspState.SuspensionInfo.Location + SuspState.SuspensionInfo.Rotation.RotateVector(HitLocation_SuspSpace)), 5.f, FColor::Green, false, /*LifeTime*/ 0.f);
-					}
-				}
-			}
-			else
-			{
-				if (bUseLineTrace)
-				{
-#if ENGINE_MINOR_VERSION >= 15
-					bHit = UKismetSystemLibrary::LineTraceSingle(this, SuspWorldLocation + RadiusUpVector, SuspTraceEndLocation - RadiusUpVector, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
-#else
-					bHit = UKismetSystemLibrary::LineTraceSingle_NEW(this, SuspWorldLocation + RadiusUpVector, SuspTraceEndLocation - RadiusUpVector, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
-#endif
-				}
-				else
-				{
-#if ENGINE_MINOR_VERSION >= 15
-					bHit = UKismetSystemLibrary::SphereTraceSingle(this, SuspWorldLocation, SuspTraceEndLocation, SuspState.SuspensionInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
-#else
-					bHit = UKismetSystemLibrary::SphereTraceSingle_NEW(this, SuspWorldLocation, SuspTraceEndLocation, SuspState.SuspensionInfo.CollisionRadius, SuspensionTraceTypeQuery, bTraceComplex, IgnoredActors, DebugType, Hit, true);
-#endif
-				}
+	return bHit;
+}
 
-				bHitValid = bHit;
-			}
+bool UPrvVehicleMovementComponent::UseAsyncTrace() const
+{
+	return bAsyncSuspensionTrace && (GPrvVehicleAsyncSuspensionTrace != 0);
+}
 
-			// Conver line hit to "sphere" hit
-			if (bUseLineTrace && bHitValid)
-			{
-				Hit.Location = Hit.ImpactPoint + RadiusUpVector;
-				Hit.Distance = (Hit.Location - SuspWorldLocation).Size();
-			}
+bool UPrvVehicleMovementComponent::TraceWheelSync(const FSuspensionState& SuspState, const FPrvWheelProbe& Probe, FHitResult& OutHit, bool& bOutHitValid)
+{
+	PRV_CYCLE_COUNTER(STAT_PrvMovementSuspensionTrace);
+	INC_DWORD_STAT(STAT_PrvMovementSuspensionTraces);
 
-			// Additional check that hit is valid (for non-spherical wheel)
-			if (bHitValid)
-			{
-				// Transform impact point to actor space
-				const FVector HitActorLocation = UpdatedMesh->GetComponentTransform().InverseTransformPosition(Hit.ImpactPoint);
+	// Most of the time wheel stays on the same primitive
+	if (TraceWheelLastContact(SuspState, Probe, OutHit, bOutHitValid))
+	{
+		return bOutHitValid;
+	}
 
-				// Check that collision is under suspension
-				if (HitActorLocation.Z >= SuspState.SuspensionInfo.Location.Z)
-				{
-					if (bDebugSuspensionLimits)
-					{
-						UE_LOG(LogPrvVehicle, Warning, TEXT("Susp Hit Forced to Zero: Collision.Z: %f, Suspension.Z: %f"), HitActorLocation.Z, SuspState.SuspensionInfo.Location.Z);
-					}
+	if (bBroadphaseActive)
+	{
+		if (BroadphaseGroundGrid && TraceWheelBakedGround(SuspState, Probe, OutHit, bOutHitValid))
+		{
+			return bOutHitValid;
+		}
 
-					// Force maximum compression
-					Hit.ImpactPoint = SuspWorldLocation;
-					Hit.ImpactNormal = SuspUpVector;
-					Hit.Distance = 0.f;
-				}
-			}
+		if (bBroadphaseLandscapeOnly && TraceWheelLandscape(SuspState, Probe, OutHit, bOutHitValid))
+		{
+			return bOutHitValid;
+		}
 
-			// Process hit results
-			if (bHitValid)
-			{
-				// Clamp suspension length because MaxDrop distance is for visuals only (non-effective compression)
-				const float NewSuspensionLength = FMath::Clamp(Hit.Distance, 0.f, SuspState.SuspensionInfo.Length);
+		return TraceWheelNarrowphase(SuspState, Probe, BroadphaseComponents, OutHit, bOutHitValid);
+	}
 
-				const float SpringCompressionRatio = FMath::Clamp((SuspState.SuspensionInfo.Length - NewSuspensionLength) / SuspState.SuspensionInfo.Length, 0.f, 1.f);
+	UWorld* World = GetWorld();
+	check(World);
 
-				SuspState.WheelCollisionLocation = Hit.ImpactPoint;
-				SuspState.WheelCollisionNormal = Hit.ImpactNormal;
-				SuspState.PreviousLength = NewSuspensionLength;
-				SuspState.WheelTouchedGround = true;
-				SuspState.SurfaceType = UGameplayStatics::GetSurfaceType(Hit);
+	bool bHit = false;
+	bOutHitValid = false;
 
-				if (SuspState.VisualLength < Hit.Distance)
-				{
-					SuspState.VisualLength = FMath::Lerp(SuspState.VisualLength, Hit.Distance, FMath::Clamp(DeltaTime * DropFactor, 0.f, 1.f));
-				}
-				else
-				{
-					SuspState.VisualLength = Hit.Distance;
-				}
-			}
-			else
-			{
-				// If there is no collision then suspension is relaxed
-				SuspState.SuspensionForce = FVector::ZeroVector;
-				SuspState.WheelCollisionLocation = FVector::ZeroVector;
-				SuspState.WheelCollisionNormal = FVector::UpVector;
-				SuspState.PreviousLength = SuspState.SuspensionInfo.Length;
-				SuspState.VisualLength = FMath::Lerp(SuspState.VisualLength, SuspState.SuspensionInfo.Length + SuspState.SuspensionInfo.MaxDrop, FMath::Clamp(DeltaTime * DropFactor, 0.f, 1.f));
-				SuspState.WheelTouchedGround = false;
-				SuspState.SurfaceType = EPhysicalSurface::SurfaceType_Default;
-			}
+	FVector TraceStart = Probe.Start;
+	FVector TraceEnd = Probe.End;
 
-			// @todo Possible push some suspension force to environment
+	if (Probe.bCylinder && !Probe.bBoxSweep)
+	{
+		TArray<FHitResult> Hits;
+		World->SweepMultiByChannel(Hits, TraceStart, TraceEnd, FQuat::Identity, SuspensionTraceChannel, Probe.GetShape(), SuspensionQueryParams, SuspensionResponseParams);
 
-			// Debug
-			if (bShowDebug)
-			{
-				// Suspension length
-				DrawDebugPoint(GetWorld(), SuspWorldLocation, 5.f, FColor(200, 0, 230), false, /*LifeTime*/ 0.f);
-				DrawDebugLine(GetWorld(), SuspWorldLocation, SuspWorldLocation - SuspUpVector * SuspState.PreviousLength, FColor::Blue, false, 0.f, 0, 4.f);
-				DrawDebugLine(GetWorld(), SuspWorldLocation, SuspWorldLocation - SuspUpVector * SuspState.SuspensionInfo.Length, FColor::Red, false, 0.f, 0, 2.f);
+		bHit = ResolveWheelHits(SuspState, Probe, Hits, OutHit, bOutHitValid);
+	}
+	else if (Probe.bBoxSweep)
+	{
+		bHit = World->SweepSingleByChannel(OutHit, TraceStart, TraceEnd, Probe.GetShapeRotation(), SuspensionTraceChannel, Probe.GetShape(), SuspensionQueryParams, SuspensionResponseParams);
+		bOutHitValid = bHit && CorrectBoxSweepHit(Probe, OutHit);
+	}
+	else
+	{
+		if (Probe.bLineTrace)
+		{
+			const FVector RadiusUpVector = Probe.UpVector * Probe.Radius;
+			TraceStart += RadiusUpVector;
+			TraceEnd -= RadiusUpVector;
 
-				// Draw wheel
-				if (bHit && SuspState.SuspensionInfo.CollisionWidth != 0.f)
-				{
-					FColor WheelColor = bHitValid ? FColor::Cyan : FColor::White;
-					FVector LineOffset = UpdatedMesh->GetComponentTransform().GetRotation().RotateVector(FVector(0.f, SuspState.SuspensionInfo.CollisionWidth / 2.f, 0.f));
-					LineOffset = SuspState.SuspensionInfo.Rotation.RotateVector(LineOffset);
-					DrawDebugCylinder(GetWorld(), Hit.Location - LineOffset, Hit.Location + LineOffset, SuspState.SuspensionInfo.CollisionRadius, 16, WheelColor, false, /*LifeTime*/ 0.f, 100);
-				}
-			}
+			bHit = World->LineTraceSingleByChannel(OutHit, TraceStart, TraceEnd, SuspensionTraceChannel, SuspensionQueryParams, SuspensionResponseParams);
+		}
+		else
+		{
+			bHit = World->SweepSingleByChannel(OutHit, TraceStart, TraceEnd, FQuat::Identity, SuspensionTraceChannel, FCollisionShape::MakeSphere(Probe.Radius), SuspensionQueryParams, SuspensionResponseParams);
 		}
+
+		bOutHitValid = bHit;
 	}
 
-	// -- [Car] --
-	if (bWheeledVehicle)
+	if (IsDebug())
 	{
-		// Update driving wheels for wheeled vehicles
-		for (auto& SuspState : SuspensionData)
+		DrawDebugLine(World, TraceStart, bOutHitValid ? OutHit.Location : TraceEnd, bOutHitValid ? FColor::Red : FColor::Green, false, /*LifeTime*/ 0.f);
+		if (bOutHitValid)
 		{
-			if (SuspState.SuspensionInfo.bSteeringWheel)
-			{
-				SuspState.SuspensionInfo.Rotation.Yaw = FMath::Lerp(SuspState.SuspensionInfo.Rotation.Yaw, EffectiveSteeringAngularSpeed, DeltaTime * (SteeringUpRatio + SteeringDownRatio) / 2.f);
-			}
+			DrawDebugPoint(World, OutHit.ImpactPoint, 8.f, FColor::Red, false, /*LifeTime*/ 0.f);
 		}
 	}
+
+	return bHit;
 }
 
-void UPrvVehicleMovementComponent::UpdateFriction(float DeltaTime)
+void UPrvVehicleMovementComponent::UpdateFriction(float DeltaTime, const FPrvBodySnapshot& Body)
 {
 	PRV_CYCLE_COUNTER(STAT_PrvMovementUpdateFriction);
 
@@ -2128,11 +3825,29 @@ void UPrvVehicleMovementComponent::UpdateFriction(float DeltaTime)
 	float MinimumWheelAngularSpeedLeft = BIG_NUMBER;
 	float MinimumWheelAngularSpeedRight = BIG_NUMBER;
 
+	FPrvSuspensionSimData& Sim = SuspensionSimData;
+	if (Sim.Num() != SuspensionData.Num())
+	{
+		return;
+	}
+
+	// Friction and drive forces are added by physics substeps
+	if (UsePhysicsSubstepForces())
+	{
+		UpdateFrictionFromSubsteps();
+		return;
+	}
+
 	// Process suspension
-	for (auto& SuspState : SuspensionData)
+	for (int32 WheelIdx = 0; WheelIdx < SuspensionData.Num(); ++WheelIdx)
 	{
-		if (SuspState.WheelTouchedGround)
+		FSuspensionState& SuspState = SuspensionData[WheelIdx];
+
+		if (Sim.Contact[WheelIdx] != 0)
 		{
+			const FVector& WheelCollisionLocation = Sim.ContactLocation[WheelIdx];
+			const FVector& WheelCollisionNormal = Sim.ContactNormal[WheelIdx];
+
 			// Cache current track info
 			FTrackInfo* WheelTrack = (SuspState.SuspensionInfo.bRightTrack) ? &RightTrack : &LeftTrack;
 			float& MinimumWheelAngularSpeed = (SuspState.SuspensionInfo.bRightTrack) ? MinimumWheelAngularSpeedLeft : MinimumWheelAngularSpeedRight;
@@ -2141,25 +3856,26 @@ void UPrvVehicleMovementComponent::UpdateFriction(float DeltaTime)
 			// Drive force
 
 			// Calculate wheel load
-			SuspState.WheelLoad = UKismetMathLibrary::ProjectVectorOnToVector(SuspState.SuspensionForce, SuspState.WheelCollisionNormal).Size();
+			Sim.Load[WheelIdx] = UKismetMathLibrary::ProjectVectorOnToVector(SuspState.SuspensionForce, WheelCollisionNormal).Size();
+			SuspState.WheelLoad = Sim.Load[WheelIdx];
 
 			// Wheel forward vector
-			const FVector WheelDirection = SuspState.SuspensionInfo.Rotation.RotateVector(UpdatedMesh->GetForwardVector());
+			const FVector WheelDirection = SuspState.SuspensionInfo.Rotation.RotateVector(Body.ForwardVector);
 
 			// Get Velocity at location
 			FVector WorldPointVelocity = FVector::ZeroVector;
 			if (bUseCustomVelocityCalculations)
 			{
-				const FVector PlaneLocalVelocity = GetOwner()->GetTransform().InverseTransformVectorNoScale(UpdatedMesh->GetPhysicsLinearVelocity());
-				const FVector PlaneAngularVelocity = GetOwner()->GetTransform().InverseTransformVectorNoScale(UpdatedMesh->GetPhysicsAngularVelocityInDegrees());
-				const FVector LocalCOM = GetOwner()->GetTransform().InverseTransformPosition(UpdatedMesh->GetCenterOfMass());
-				const FVector LocalCollisionLocation = GetOwner()->GetTransform().InverseTransformPosition(SuspState.WheelCollisionLocation);
+				const FVector PlaneLocalVelocity = Body.OwnerTransform.InverseTransformVectorNoScale(Body.LinearVelocity);
+				const FVector PlaneAngularVelocity = Body.OwnerTransform.InverseTransformVectorNoScale(Body.AngularVelocityInDegrees);
+				const FVector LocalCOM = Body.OwnerTransform.InverseTransformPosition(Body.CenterOfMass);
+				const FVector LocalCollisionLocation = Body.OwnerTransform.InverseTransformPosition(WheelCollisionLocation);
 				const FVector LocalPointVelocity = PlaneLocalVelocity + FVector::CrossProduct(FMath::DegreesToRadians(PlaneAngularVelocity), (LocalCollisionLocation - LocalCOM));
-				WorldPointVelocity = GetOwner()->GetTransform().TransformVectorNoScale(LocalPointVelocity);
+				WorldPointVelocity = Body.OwnerTransform.TransformVectorNoScale(LocalPointVelocity);
 			}
 			else
 			{
-				WorldPointVelocity = UpdatedMesh->GetPhysicsLinearVelocityAtPoint(SuspState.WheelCollisionLocation);
+				WorldPointVelocity = Body.GetVelocityAtPoint(WheelCollisionLocation);
 			}
 
 			// Calculate wheel velocity relative to track (with simple Kalman filter)
@@ -2177,23 +3893,23 @@ void UPrvVehicleMovementComponent::UpdateFriction(float DeltaTime)
 				WheelVelocity += (WheelDirection * WheelTrack->LinearSpeed);
 			}
 
-			const FVector RelativeWheelVelocity = UKismetMathLibrary::ProjectVectorOnToPlane(WheelVelocity, SuspState.WheelCollisionNormal);
+			const FVector RelativeWheelVelocity = UKismetMathLibrary::ProjectVectorOnToPlane(WheelVelocity, WheelCollisionNormal);
 
 			// Get friction coefficients
 			
 	
 
 			// Mass and friction forces
-			const float VehicleMass = UpdatedMesh->GetMass();
-			const FVector FrictionXVector = UKismetMathLibrary::ProjectVectorOnToPlane(UpdatedMesh->GetForwardVector(), SuspState.WheelCollisionNormal).GetSafeNormal();
-			const FVector FrictionYVector = UKismetMathLibrary::ProjectVectorOnToPlane(UpdatedMesh->GetRightVector(), SuspState.WheelCollisionNormal).GetSafeNormal();
+			const float VehicleMass = Body.Mass;
+			const FVector FrictionXVector = UKismetMathLibrary::ProjectVectorOnToPlane(Body.ForwardVector, WheelCollisionNormal).GetSafeNormal();
+			const FVector FrictionYVector = UKismetMathLibrary::ProjectVectorOnToPlane(Body.RightVector, WheelCollisionNormal).GetSafeNormal();
 
 			// Current wheel force contbution
 			FVector WheelBalancedForce = FVector::ZeroVector;
 			if (ActiveFrictionPoints != 0)
 			{
 				const FVector GravityDirection = -FVector::UpVector;
-				const FVector GravityBasedFriction = UKismetMathLibrary::ProjectVectorOnToPlane(GravityDirection * UPhysicsSettings::Get()->DefaultGravityZ * VehicleMass / ActiveFrictionPoints, UpdatedMesh->GetUpVector());
+				const FVector GravityBasedFriction = UKismetMathLibrary::ProjectVectorOnToPlane(GravityDirection * Body.GravityZ * VehicleMass / ActiveFrictionPoints, Body.UpVector);
 				WheelBalancedForce = RelativeWheelVelocity * VehicleMass / DeltaTime / ActiveFrictionPoints + GravityBasedFriction;
 			}
 
@@ -2207,7 +3923,7 @@ void UPrvVehicleMovementComponent::UpdateFriction(float DeltaTime)
 			}
 
 			// Drive Force from transmission torque
-			FVector TransmissionDriveForce = UKismetMathLibrary::ProjectVectorOnToPlane(WheelTrack->DriveForce, SuspState.WheelCollisionNormal);
+			FVector TransmissionDriveForce = UKismetMathLibrary::ProjectVectorOnToPlane(WheelTrack->DriveForce, WheelCollisionNormal);
 			UE_LOG(LogTemp,Log,TEXT("Drive %s"),*TransmissionDriveForce.ToString());
 			if (bScaleForceToActiveFrictionPoints && ActiveDrivenFrictionPoints != 0 && SuspensionData.Num() != 0)
 			{
@@ -2223,20 +3939,22 @@ void UPrvVehicleMovementComponent::UpdateFriction(float DeltaTime)
 			
 			
 			
-			const FVector ApplicationForce = FullDriveForce.GetClampedToMaxSize(SuspState.WheelLoad * 1);
+			const FVector ApplicationForce = FullDriveForce.GetClampedToMaxSize(Sim.Load[WheelIdx] * 1);
 							
 			
-				const float WorldPointForwardVectorSpeed = FVector::DotProduct(WorldPointVelocity, UpdatedMesh->GetForwardVector());
+				const float WorldPointForwardVectorSpeed = FVector::DotProduct(WorldPointVelocity, Body.ForwardVector);
 				const float CurrentAngularSpeed = WorldPointForwardVectorSpeed / SprocketRadius;
 				MinimumWheelAngularSpeed = FMath::Min(MinimumWheelAngularSpeed, CurrentAngularSpeed);
 				WheelTrack->AngularSpeed = MinimumWheelAngularSpeed;
 			
 
 			// Apply force to mesh
-			if (ShouldAddForce())
+			SuspState.FrictionForce = FVector::ZeroVector;
+			if (Body.bAddForce)
 			{
 				UE_LOG(LogTemp,Log,TEXT("Applicationforce %s"),*ApplicationForce.ToString());
-				UpdatedMesh->AddForceAtLocation(ApplicationForce*CustomForceMuliplier, SuspState.WheelCollisionLocation);
+				SuspState.FrictionForce = ApplicationForce * CustomForceMuliplier;
+				ForceAccumulator.AddForceAtLocation(SuspState.FrictionForce, WheelCollisionLocation);
 			}
 
 			/////////////////////////////////////////////////////////////////////////
@@ -2267,19 +3985,148 @@ void UPrvVehicleMovementComponent::UpdateFriction(float DeltaTime)
 				
 
 				// Force application
-				DrawDebugLine(GetWorld(), SuspState.WheelCollisionLocation, SuspState.WheelCollisionLocation + ApplicationForce * 0.0001f, FColor::Cyan, false, 0.f, 0, 10.f);
+				DrawDebugLine(GetWorld(), WheelCollisionLocation, WheelCollisionLocation + ApplicationForce * 0.0001f, FColor::Cyan, false, 0.f, 0, 10.f);
 
 				// Wheel velocity vectors
-				DrawDebugLine(GetWorld(), SuspState.WheelCollisionLocation, SuspState.WheelCollisionLocation + WheelCollisionVelocity, FColor::Yellow, false, 0.f, 0, 8.f);
-				DrawDebugLine(GetWorld(), SuspState.WheelCollisionLocation, SuspState.WheelCollisionLocation + RelativeWheelVelocity, FColor::Blue, false, 0.f, 0, 8.f);
+				DrawDebugLine(GetWorld(), WheelCollisionLocation, WheelCollisionLocation + WheelCollisionVelocity, FColor::Yellow, false, 0.f, 0, 8.f);
+				DrawDebugLine(GetWorld(), WheelCollisionLocation, WheelCollisionLocation + RelativeWheelVelocity, FColor::Blue, false, 0.f, 0, 8.f);
 			}
 		}
 		else
 		{
 			// Reset wheel load
+			Sim.Load[WheelIdx] = 0.f;
 			SuspState.WheelLoad = 0.f;
+			SuspState.FrictionForce = FVector::ZeroVector;
+		}
+	}
+}
+
+void UPrvVehicleMovementComponent::UpdateFrictionFromSubsteps()
+{
+	const bool bSubstepOutput = HasPhysicsSubstepOutput();
+	const FPrvSubstepOutput* SubstepOutput = bSubstepOutput ? &SubstepForces->GetOutput() : nullptr;
+
+	FPrvSuspensionSimData& Sim = SuspensionSimData;
+	for (int32 WheelIdx = 0; WheelIdx < SuspensionData.Num(); ++WheelIdx)
+	{
+		FSuspensionState& SuspState = SuspensionData[WheelIdx];
+
+		Sim.Load[WheelIdx] = (Sim.Contact[WheelIdx] != 0) ? UKismetMathLibrary::ProjectVectorOnToVector(SuspState.SuspensionForce, Sim.ContactNormal[WheelIdx]).Size() : 0.f;
+		SuspState.WheelLoad = Sim.Load[WheelIdx];
+		SuspState.FrictionForce = bSubstepOutput ? SubstepOutput->FrictionForce[WheelIdx] : FVector::ZeroVector;
+	}
+
+	// Tracks follow ground speed under their wheels as seen by the last substep
+	if (bSubstepOutput)
+	{
+		if (SubstepOutput->bTrackContact[0])
+		{
+			LeftTrack.AngularSpeed = SubstepOutput->TrackAngularSpeed[0];
+		}
+
+		if (SubstepOutput->bTrackContact[1])
+		{
+			RightTrack.AngularSpeed = SubstepOutput->TrackAngularSpeed[1];
+		}
+	}
+}
+
+void UPrvVehicleMovementComponent::FlushForceAccumulator()
+{
+	// Whole tick contribution goes to physics with one write per quantity
+	if (UPrvVehicleSubsystem* PhysicsCommandQueue = GetPhysicsCommandQueue())
+	{
+		if (!ForceAccumulator.Force.IsZero())
+		{
+			PhysicsCommandQueue->QueuePhysicsCommand(FPrvPhysicsCommand(UpdatedMesh, EPrvPhysicsCommandType::Force, ForceAccumulator.Force));
+		}
+
+		if (!ForceAccumulator.Torque.IsZero())
+		{
+			PhysicsCommandQueue->QueuePhysicsCommand(FPrvPhysicsCommand(UpdatedMesh, EPrvPhysicsCommandType::Torque, ForceAccumulator.Torque));
+		}
+
+		if (ForceAccumulator.bSetAngularVelocity)
+		{
+			PhysicsCommandQueue->QueuePhysicsCommand(FPrvPhysicsCommand(UpdatedMesh, EPrvPhysicsCommandType::AngularVelocity, ForceAccumulator.AngularVelocityInDegrees));
+		}
+	}
+	else
+	{
+		if (!ForceAccumulator.Force.IsZero())
+		{
+			UpdatedMesh->AddForce(ForceAccumulator.Force);
+		}
+
+		if (!ForceAccumulator.Torque.IsZero())
+		{
+			UpdatedMesh->AddTorqueInRadians(ForceAccumulator.Torque);
+		}
+
+		if (ForceAccumulator.bSetAngularVelocity)
+		{
+			UpdatedMesh->SetPhysicsAngularVelocityInDegrees(ForceAccumulator.AngularVelocityInDegrees);
+		}
+	}
+
+	// Debug
+	if (bShowDebug)
+	{
+		DrawDebugLine(GetWorld(), ForceAccumulator.CenterOfMass, ForceAccumulator.CenterOfMass + ForceAccumulator.Force * 0.0001f, FColor::Orange, false, /*LifeTime*/ 0.f, /*DepthPriority*/ 0, /*Thickness*/ 6.f);
+		DrawDebugLine(GetWorld(), ForceAccumulator.CenterOfMass, ForceAccumulator.CenterOfMass + ForceAccumulator.Torque * 0.00001f, FColor::Magenta, false, /*LifeTime*/ 0.f, /*DepthPriority*/ 0, /*Thickness*/ 6.f);
+	}
+
+	ForceAccumulator.Reset(ForceAccumulator.CenterOfMass);
+}
+
+void UPrvVehicleMovementComponent::AddReactionForce(UPrimitiveComponent* Component, const FVector& Force, const FVector& Location)
+{
+	// Wheels usually stand on a few primitives only
+	FPrvReactionForce* Reaction = ReactionForces.FindByPredicate([Component](const FPrvReactionForce& Other) { return Other.Component == Component; });
+	if (Reaction == nullptr)
+	{
+		Reaction = &ReactionForces[ReactionForces.Emplace(Component, Location)];
+	}
+
+	Reaction->AddForceAtLocation(Force, Location);
+}
+
+void UPrvVehicleMovementComponent::FlushReactionForces(UPrvVehicleSubsystem* PhysicsCommandQueue)
+{
+	for (const FPrvReactionForce& Reaction : ReactionForces)
+	{
+		UPrimitiveComponent* Component = Reaction.Component.Get();
+		if (Component == nullptr || Reaction.Force.IsZero())
+		{
+			continue;
+		}
+
+		if (PhysicsCommandQueue)
+		{
+			PhysicsCommandQueue->QueueReactionForce(Reaction);
+		}
+		else
+		{
+			// Move torque from the reference point to the center of mass
+			const FVector CenterOfMass = Component->GetCenterOfMass();
+			Component->AddForce(Reaction.Force);
+			Component->AddTorqueInRadians(Reaction.Torque + FVector::CrossProduct(Reaction.ReferencePoint - CenterOfMass, Reaction.Force));
 		}
 	}
+
+	ReactionForces.Reset();
+}
+
+UPrvVehicleSubsystem* UPrvVehicleMovementComponent::GetPhysicsCommandQueue() const
+{
+	if (!bDeferredPhysicsCommands || GPrvVehicleDeferredPhysicsCommands == 0)
+	{
+		return nullptr;
+	}
+
+	UWorld* World = GetWorld();
+	return World ? World->GetSubsystem<UPrvVehicleSubsystem>() : nullptr;
 }
 
 void UPrvVehicleMovementComponent::UpdateLinearVelocity(float DeltaTime)
@@ -2294,12 +4141,25 @@ void UPrvVehicleMovementComponent::UpdateAngularVelocity(float DeltaTime)
 
 void UPrvVehicleMovementComponent::AnimateWheels(float DeltaTime)
 {
-	for (auto& SuspState : SuspensionData)
+	// Physics substeps rotate wheels with their own time step
+	const FPrvSubstepOutput* SubstepOutput = HasPhysicsSubstepOutput() ? &SubstepForces->GetOutput() : nullptr;
+
+	for (int32 WheelIdx = 0; WheelIdx < SuspensionData.Num(); ++WheelIdx)
 	{
-		const float EffectiveAngularSpeed = (SuspState.SuspensionInfo.bRightTrack) ? RightTrackEffectiveAngularSpeed : LeftTrackEffectiveAngularSpeed;
+		FSuspensionState& SuspState = SuspensionData[WheelIdx];
+
+		if (SubstepOutput)
+		{
+			SuspState.RotationAngle = SubstepOutput->RotationAngle[WheelIdx];
+		}
+		else
+		{
+			const float EffectiveAngularSpeed = (SuspState.SuspensionInfo.bRightTrack) ? RightTrackEffectiveAngularSpeed : LeftTrackEffectiveAngularSpeed;
+
+			SuspState.RotationAngle -= FMath::RadiansToDegrees(EffectiveAngularSpeed) * DeltaTime * (SprocketRadius / VisualCollisionRadius);
+			SuspState.RotationAngle = FRotator::NormalizeAxis(SuspState.RotationAngle);
+		}
 
-		SuspState.RotationAngle -= FMath::RadiansToDegrees(EffectiveAngularSpeed) * DeltaTime * (SprocketRadius / VisualCollisionRadius);
-		SuspState.RotationAngle = FRotator::NormalizeAxis(SuspState.RotationAngle);
 		SuspState.SteeringAngle = SuspState.SuspensionInfo.Rotation.Yaw;
 	}
 }
@@ -2835,7 +4695,7 @@ bool UPrvVehicleMovementComponent::HasInput() const
 	return FMath::Abs(RawThrottleInput) > SMALL_NUMBER || FMath::Abs(RawSteeringInput) > SMALL_NUMBER || bRawHandbrakeInput;
 }
 
-bool UPrvVehicleMovementComponent::ShouldAddForce()
+bool UPrvVehicleMovementComponent::ShouldAddForce() const
 {
 	ENetRole OwnerRole = GetOwner()->GetLocalRole();
 	const bool bPhysicsIsSimulated = UpdatedComponent ? UpdatedComponent->IsSimulatingPhysics() : false;
@@ -3215,4 +5075,19 @@ void UPrvVehicleMovementComponent::BeginPlay()
 		}
 	}
 
-}
\ No newline at end of file
+	// Register in vehicle subsystem to share world-level services
+	if (UPrvVehicleSubsystem* VehicleSubsystem = GetWorld()->GetSubsystem<UPrvVehicleSubsystem>())
+	{
+		VehicleSubsystem->RegisterVehicle(this);
+	}
+}
+
+void UPrvVehicleMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UPrvVehicleSubsystem* VehicleSubsystem = GetWorld()->GetSubsystem<UPrvVehicleSubsystem>())
+	{
+		VehicleSubsystem->UnregisterVehicle(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
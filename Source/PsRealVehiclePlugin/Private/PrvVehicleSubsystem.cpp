@@ -0,0 +1,663 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#include "PrvVehicleSubsystem.h"
+
+#include "PrvPlugin.h"
+#include "PrvVehicleMovementComponent.h"
+
+#include "Async/ParallelFor.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+#include "Physics/PhysicsInterfaceCore.h"
+#include "PhysicsEngine/BodyInstance.h"
+#include "PhysicsPublic.h"
+
+DECLARE_CYCLE_STAT(TEXT("Subsystem Tick"), STAT_PrvSubsystemTick, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Batched Vehicles Tick"), STAT_PrvSubsystemTickVehicles, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Batched Vehicles"), STAT_PrvBatchedVehicles, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Batched Drivetrain"), STAT_PrvSubsystemDrivetrain, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Batched Wheel Probes"), STAT_PrvSubsystemProbeWheels, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Parallel Probe Mismatches"), STAT_PrvParallelProbeMismatches, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Flush Suspension Probes"), STAT_PrvSubsystemFlushProbes, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Async Suspension Probes"), STAT_PrvAsyncSuspensionProbes, STATGROUP_MovementPhysics);
+DECLARE_CYCLE_STAT(TEXT("Flush Physics Commands"), STAT_PrvSubsystemFlushPhysicsCommands, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Physics Commands"), STAT_PrvPhysicsCommands, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Reaction Forces"), STAT_PrvReactionForces, STATGROUP_MovementPhysics);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Reaction Forces Filtered"), STAT_PrvReactionForcesFiltered, STATGROUP_MovementPhysics);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Ground Grid Resident Tiles"), STAT_PrvGroundGridResidentTiles, STATGROUP_MovementPhysics);
+
+static int32 GPrvVehicleGroundGridMaxTiles = 256;
+static FAutoConsoleVariableRef CVarPrvVehicleGroundGridMaxTiles(
+	TEXT("PrvVehicle.GroundGridMaxTiles"),
+	GPrvVehicleGroundGridMaxTiles,
+	TEXT("Max number of baked ground grid tiles kept mapped in memory"));
+
+static float GPrvVehicleReactionForceMinMass = 0.f;
+static FAutoConsoleVariableRef CVarPrvVehicleReactionForceMinMass(
+	TEXT("PrvVehicle.ReactionForceMinMass"),
+	GPrvVehicleReactionForceMinMass,
+	TEXT("Suspension reaction forces aren't applied to simulating primitives lighter than this [kg], 0 to push everything"));
+
+static int32 GPrvVehicleBatchedTick = 0;
+static FAutoConsoleVariableRef CVarPrvVehicleBatchedTick(
+	TEXT("PrvVehicle.BatchedTick"),
+	GPrvVehicleBatchedTick,
+	TEXT("Ticks all vehicles by vehicle subsystem stage by stage instead of their own tick functions"));
+
+static int32 GPrvVehicleParallelDrivetrain = 1;
+static FAutoConsoleVariableRef CVarPrvVehicleParallelDrivetrain(
+	TEXT("PrvVehicle.ParallelDrivetrain"),
+	GPrvVehicleParallelDrivetrain,
+	TEXT("Runs control and drivetrain stages of batched vehicles on worker threads"));
+
+static int32 GPrvVehicleParallelProbes = 1;
+static FAutoConsoleVariableRef CVarPrvVehicleParallelProbes(
+	TEXT("PrvVehicle.ParallelProbes"),
+	GPrvVehicleParallelProbes,
+	TEXT("Makes wheel probes of batched vehicles on worker threads"));
+
+static int32 GPrvVehicleValidateParallelProbes = 0;
+static FAutoConsoleVariableRef CVarPrvVehicleValidateParallelProbes(
+	TEXT("PrvVehicle.ValidateParallelProbes"),
+	GPrvVehicleValidateParallelProbes,
+	TEXT("Repeats parallel wheel probes on game thread and reports contacts that differ"));
+
+/** Vehicle state kept between stages of the batched tick */
+struct FPrvBatchedVehicle
+{
+	UPrvVehicleMovementComponent* Vehicle;
+	FPrvBodySnapshot Body;
+	float DeltaTime;
+	EPrvTickSimulation Simulation;
+
+	/** Wheels are probed on worker thread */
+	bool bParallelProbes;
+
+	/** Wheels state before parallel probes (validation only) */
+	TArray<FSuspensionState> WheelsBeforeProbes;
+
+	FPrvBatchedVehicle()
+		: Vehicle(nullptr)
+		, DeltaTime(0.f)
+		, Simulation(EPrvTickSimulation::None)
+		, bParallelProbes(false)
+	{
+	}
+};
+
+//////////////////////////////////////////////////////////////////////////
+// FPrvVehicleSubsystemTickFunction
+
+void FPrvVehicleSubsystemTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Target && !Target->IsPendingKill())
+	{
+		Target->Tick(DeltaTime);
+	}
+}
+
+FString FPrvVehicleSubsystemTickFunction::DiagnosticMessage()
+{
+	return TEXT("FPrvVehicleSubsystemTickFunction");
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FPrvVehicleBatchTickFunction
+
+void FPrvVehicleBatchTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Target && !Target->IsPendingKill())
+	{
+		Target->TickVehicles(DeltaTime, TickType);
+	}
+}
+
+FString FPrvVehicleBatchTickFunction::DiagnosticMessage()
+{
+	return TEXT("FPrvVehicleBatchTickFunction");
+}
+
+//////////////////////////////////////////////////////////////////////////
+// UPrvVehicleSubsystem
+
+UPrvVehicleSubsystem::UPrvVehicleSubsystem()
+{
+	PendingFrameNumber = 0;
+	SubmittedFrameNumber = 0;
+	PhysicsCommandsFrameNumber = 0;
+	bGroundGridRequested = false;
+	bBatchedTick = false;
+}
+
+void UPrvVehicleSubsystem::Deinitialize()
+{
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.UnRegisterTickFunction();
+	}
+
+	if (BatchTickFunction.IsTickFunctionRegistered())
+	{
+		BatchTickFunction.UnRegisterTickFunction();
+	}
+
+	Vehicles.Empty();
+	PendingProbes.Empty();
+	SubmittedProbes.Empty();
+	PendingPhysicsCommands.Empty();
+	PendingReactionForces.Empty();
+	ReactionForceIndices.Empty();
+
+	GroundGrid.Close();
+	GroundGridMaterials.Empty();
+
+	Super::Deinitialize();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Vehicles registry
+
+void UPrvVehicleSubsystem::RegisterVehicle(UPrvVehicleMovementComponent* Vehicle)
+{
+	UWorld* World = GetWorld();
+	if (Vehicle == nullptr || World == nullptr)
+	{
+		return;
+	}
+
+	// Register tick function on first vehicle (persistent level isn't ready on subsystem init)
+	if (!TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.Target = this;
+		TickFunction.bCanEverTick = true;
+		TickFunction.bTickEvenWhenPaused = false;
+		TickFunction.TickGroup = TG_PrePhysics;
+		TickFunction.RegisterTickFunction(World->PersistentLevel);
+	}
+
+	if (!BatchTickFunction.IsTickFunctionRegistered())
+	{
+		BatchTickFunction.Target = this;
+		BatchTickFunction.bCanEverTick = true;
+		BatchTickFunction.bTickEvenWhenPaused = false;
+		BatchTickFunction.TickGroup = TG_PrePhysics;
+		BatchTickFunction.RegisterTickFunction(World->PersistentLevel);
+
+		// Batched vehicles queue their probes and forces before we flush them
+		TickFunction.AddPrerequisite(this, BatchTickFunction);
+	}
+
+	Vehicles.AddUnique(Vehicle);
+
+	if (bBatchedTick)
+	{
+		Vehicle->bBatchedTick = true;
+		Vehicle->SetComponentTickEnabled(false);
+	}
+
+	// Vehicles should queue their probes before we flush them
+	TickFunction.AddPrerequisite(Vehicle, Vehicle->PrimaryComponentTick);
+}
+
+void UPrvVehicleSubsystem::UnregisterVehicle(UPrvVehicleMovementComponent* Vehicle)
+{
+	if (Vehicle == nullptr)
+	{
+		return;
+	}
+
+	Vehicles.Remove(Vehicle);
+	Vehicle->bBatchedTick = false;
+
+	if (TickFunction.IsTickFunctionRegistered())
+	{
+		TickFunction.RemovePrerequisite(Vehicle, Vehicle->PrimaryComponentTick);
+	}
+}
+
+void UPrvVehicleSubsystem::Tick(float DeltaTime)
+{
+	PRV_CYCLE_COUNTER(STAT_PrvSubsystemTick);
+
+	FlushProbes();
+	FlushPhysicsCommands();
+
+	if (GroundGrid.IsOpen())
+	{
+		GroundGrid.SetMaxResidentTiles(GPrvVehicleGroundGridMaxTiles);
+		SET_DWORD_STAT(STAT_PrvGroundGridResidentTiles, GroundGrid.GetResidentTilesNum());
+	}
+}
+
+void UPrvVehicleSubsystem::TickVehicles(float DeltaTime, ELevelTick TickType)
+{
+	PRV_CYCLE_COUNTER(STAT_PrvSubsystemTickVehicles);
+
+	// Switch is made here, so each vehicle is ticked once on the frame
+	const bool bWantsBatchedTick = (GPrvVehicleBatchedTick != 0);
+	if (bBatchedTick != bWantsBatchedTick)
+	{
+		SetBatchedTick(bWantsBatchedTick);
+	}
+
+	if (!bBatchedTick)
+	{
+		return;
+	}
+
+	TArray<FPrvBatchedVehicle> Batch;
+	Batch.Reserve(Vehicles.Num());
+
+	// Input and body snapshots
+	for (const TWeakObjectPtr<UPrvVehicleMovementComponent>& VehiclePtr : Vehicles)
+	{
+		UPrvVehicleMovementComponent* Vehicle = VehiclePtr.Get();
+		if (Vehicle == nullptr || !Vehicle->IsActive() || !Vehicle->IsRegistered())
+		{
+			continue;
+		}
+
+		FPrvBatchedVehicle& Batched = Batch.AddDefaulted_GetRef();
+		Batched.Vehicle = Vehicle;
+
+		// Component tick is dilated by its owner
+		const AActor* Owner = Vehicle->GetOwner();
+		Batched.DeltaTime = Owner ? DeltaTime * Owner->CustomTimeDilation : DeltaTime;
+
+		if (!Vehicle->BeginTick(Batched.DeltaTime, TickType, &Vehicle->PrimaryComponentTick, Batched.Body))
+		{
+			Batch.Pop(false);
+			continue;
+		}
+
+		Batched.Simulation = Vehicle->BeginSimulation(Batched.DeltaTime, Batched.Body);
+	}
+
+	INC_DWORD_STAT_BY(STAT_PrvBatchedVehicles, Batch.Num());
+
+	// Fixed steps loop over stages inside of the vehicle
+	for (const FPrvBatchedVehicle& Batched : Batch)
+	{
+		if (Batched.Simulation == EPrvTickSimulation::FixedSteps && !Batched.Vehicle->IsPendingKill())
+		{
+			Batched.Vehicle->SimulateFixedSteps(Batched.DeltaTime, Batched.Body);
+		}
+	}
+
+	// Wheel probes of all vehicles
+	{
+		PRV_CYCLE_COUNTER(STAT_PrvSubsystemProbeWheels);
+
+		const bool bParallelProbes = (GPrvVehicleParallelProbes != 0);
+		const bool bValidateParallelProbes = bParallelProbes && (GPrvVehicleValidateParallelProbes != 0);
+
+		for (FPrvBatchedVehicle& Batched : Batch)
+		{
+			Batched.bParallelProbes = bParallelProbes && Batched.Simulation == EPrvTickSimulation::Step && !Batched.Vehicle->IsPendingKill() && Batched.Vehicle->CanProbeWheelsInParallel();
+			if (Batched.bParallelProbes && bValidateParallelProbes)
+			{
+				Batched.WheelsBeforeProbes = Batched.Vehicle->SuspensionData;
+			}
+		}
+
+		// Scene queries take physics scene read lock themselves, results go to vehicle own contact buffers
+		if (bParallelProbes)
+		{
+			ParallelFor(Batch.Num(), [&Batch](int32 Index)
+			{
+				const FPrvBatchedVehicle& Batched = Batch[Index];
+				if (Batched.bParallelProbes)
+				{
+					Batched.Vehicle->ProbeWheels(Batched.Body);
+				}
+			});
+		}
+
+		for (const FPrvBatchedVehicle& Batched : Batch)
+		{
+			if (Batched.Simulation == EPrvTickSimulation::Step && !Batched.bParallelProbes && !Batched.Vehicle->IsPendingKill())
+			{
+				Batched.Vehicle->ProbeWheels(Batched.Body);
+			}
+		}
+
+		// Serial reference probes run on copies, so validation doesn't change simulation
+		if (bValidateParallelProbes)
+		{
+			for (const FPrvBatchedVehicle& Batched : Batch)
+			{
+				if (Batched.bParallelProbes)
+				{
+					INC_DWORD_STAT_BY(STAT_PrvParallelProbeMismatches, Batched.Vehicle->ValidateProbeWheels(Batched.Body, Batched.WheelsBeforeProbes));
+				}
+			}
+		}
+	}
+
+	// Suspension of all vehicles
+	for (const FPrvBatchedVehicle& Batched : Batch)
+	{
+		if (Batched.Simulation == EPrvTickSimulation::Step && !Batched.Vehicle->IsPendingKill())
+		{
+			Batched.Vehicle->UpdateSuspension(Batched.DeltaTime, Batched.Body);
+		}
+	}
+
+	// Friction of all vehicles
+	for (const FPrvBatchedVehicle& Batched : Batch)
+	{
+		if (Batched.Simulation == EPrvTickSimulation::Step && !Batched.Vehicle->IsPendingKill())
+		{
+			Batched.Vehicle->UpdateFriction(Batched.DeltaTime, Batched.Body);
+		}
+	}
+
+	// Control and drivetrain of all vehicles
+	{
+		PRV_CYCLE_COUNTER(STAT_PrvSubsystemDrivetrain);
+
+		// These stages change only vehicle own state, debug drawing is the exception
+		auto CanRunInParallel = [](const FPrvBatchedVehicle& Batched)
+		{
+			return !Batched.Vehicle->bShowDebug;
+		};
+
+		const bool bParallelDrivetrain = (GPrvVehicleParallelDrivetrain != 0);
+		if (bParallelDrivetrain)
+		{
+			ParallelFor(Batch.Num(), [&Batch, &CanRunInParallel](int32 Index)
+			{
+				const FPrvBatchedVehicle& Batched = Batch[Index];
+				if (Batched.Simulation == EPrvTickSimulation::Step && !Batched.Vehicle->IsPendingKill() && CanRunInParallel(Batched))
+				{
+					Batched.Vehicle->bDeferGameThreadEvents = true;
+					Batched.Vehicle->SimulateDrivetrain(Batched.DeltaTime, Batched.Body);
+					Batched.Vehicle->bDeferGameThreadEvents = false;
+				}
+			});
+		}
+
+		for (const FPrvBatchedVehicle& Batched : Batch)
+		{
+			if (Batched.Simulation == EPrvTickSimulation::Step && !Batched.Vehicle->IsPendingKill() && !(bParallelDrivetrain && CanRunInParallel(Batched)))
+			{
+				Batched.Vehicle->SimulateDrivetrain(Batched.DeltaTime, Batched.Body);
+			}
+		}
+
+		// Gear shift timers and events of parallel stages
+		for (const FPrvBatchedVehicle& Batched : Batch)
+		{
+			Batched.Vehicle->FlushDeferredEvents();
+		}
+	}
+
+	// Forces and wheels of all vehicles
+	for (const FPrvBatchedVehicle& Batched : Batch)
+	{
+		if (!Batched.Vehicle->IsPendingKill())
+		{
+			Batched.Vehicle->EndTick(Batched.DeltaTime, Batched.Body, Batched.Simulation);
+		}
+	}
+}
+
+void UPrvVehicleSubsystem::SetBatchedTick(bool bEnable)
+{
+	bBatchedTick = bEnable;
+
+	for (const TWeakObjectPtr<UPrvVehicleMovementComponent>& VehiclePtr : Vehicles)
+	{
+		if (UPrvVehicleMovementComponent* Vehicle = VehiclePtr.Get())
+		{
+			Vehicle->bBatchedTick = bEnable;
+
+			// Inactive vehicles keep their tick disabled
+			Vehicle->SetComponentTickEnabled(!bEnable && Vehicle->IsActive());
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Suspension probes
+
+FPrvProbeTicket UPrvVehicleSubsystem::RequestProbe(const FPrvProbeRequest& Request)
+{
+	// Drop probes that were never submitted (subsystem wasn't ticked)
+	if (PendingFrameNumber != GFrameCounter)
+	{
+		PendingProbes.Reset();
+		PendingFrameNumber = GFrameCounter;
+	}
+
+	FPrvProbeTicket Ticket;
+	Ticket.FrameNumber = PendingFrameNumber;
+	Ticket.Index = PendingProbes.Add(Request);
+
+	return Ticket;
+}
+
+bool UPrvVehicleSubsystem::GetProbeResult(const FPrvProbeTicket& Ticket, TArray<FHitResult>& OutHits)
+{
+	OutHits.Reset();
+
+	UWorld* World = GetWorld();
+	if (World == nullptr || !Ticket.IsValid() || Ticket.FrameNumber != SubmittedFrameNumber || !SubmittedProbes.IsValidIndex(Ticket.Index))
+	{
+		return false;
+	}
+
+	FTraceDatum TraceDatum;
+	if (!World->QueryTraceData(SubmittedProbes[Ticket.Index], TraceDatum))
+	{
+		return false;
+	}
+
+	OutHits = MoveTemp(TraceDatum.OutHits);
+	return true;
+}
+
+void UPrvVehicleSubsystem::FlushProbes()
+{
+	PRV_CYCLE_COUNTER(STAT_PrvSubsystemFlushProbes);
+
+	UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return;
+	}
+
+	SubmittedProbes.Reset();
+	SubmittedFrameNumber = PendingFrameNumber;
+
+	if (PendingFrameNumber != GFrameCounter)
+	{
+		PendingProbes.Reset();
+		return;
+	}
+
+	SubmittedProbes.Reserve(PendingProbes.Num());
+	for (const FPrvProbeRequest& Request : PendingProbes)
+	{
+		if (Request.Shape.IsLine())
+		{
+			SubmittedProbes.Add(World->AsyncLineTraceByChannel(Request.TraceType, Request.Start, Request.End, Request.Channel, Request.QueryParams, Request.ResponseParams));
+		}
+		else
+		{
+			SubmittedProbes.Add(World->AsyncSweepByChannel(Request.TraceType, Request.Start, Request.End, Request.Rotation, Request.Channel, Request.Shape, Request.QueryParams, Request.ResponseParams));
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_PrvAsyncSuspensionProbes, PendingProbes.Num());
+
+	PendingProbes.Reset();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Physics commands
+
+void UPrvVehicleSubsystem::QueuePhysicsCommand(const FPrvPhysicsCommand& Command)
+{
+	ResetStalePhysicsCommands();
+
+	PendingPhysicsCommands.Add(Command);
+}
+
+void UPrvVehicleSubsystem::QueueReactionForce(const FPrvReactionForce& Reaction)
+{
+	UPrimitiveComponent* Component = Reaction.Component.Get();
+	if (Component == nullptr)
+	{
+		return;
+	}
+
+	ResetStalePhysicsCommands();
+
+	int32& ReactionIndex = ReactionForceIndices.FindOrAdd(Component, INDEX_NONE);
+	if (ReactionIndex == INDEX_NONE)
+	{
+		ReactionIndex = PendingReactionForces.Add(Reaction);
+	}
+	else
+	{
+		PendingReactionForces[ReactionIndex].Add(Reaction);
+	}
+}
+
+void UPrvVehicleSubsystem::ResetStalePhysicsCommands()
+{
+	// Drop commands that were never applied (subsystem wasn't ticked)
+	if (PhysicsCommandsFrameNumber != GFrameCounter)
+	{
+		PendingPhysicsCommands.Reset();
+		PendingReactionForces.Reset();
+		ReactionForceIndices.Reset();
+		PhysicsCommandsFrameNumber = GFrameCounter;
+	}
+}
+
+/** Body instance that can receive forces (caller should hold scene write lock) */
+static FBodyInstance* GetSimulatingBody_AssumesLocked(UPrimitiveComponent* Component)
+{
+	FBodyInstance* BodyInstance = Component ? Component->GetBodyInstance() : nullptr;
+	if (BodyInstance == nullptr || !BodyInstance->IsInstanceSimulatingPhysics())
+	{
+		return nullptr;
+	}
+
+	const FPhysicsActorHandle& ActorHandle = BodyInstance->GetPhysicsActorHandle();
+	if (!FPhysicsInterface::IsValid(ActorHandle) || !FPhysicsInterface::IsRigidBody(ActorHandle))
+	{
+		return nullptr;
+	}
+
+	return BodyInstance;
+}
+
+void UPrvVehicleSubsystem::FlushPhysicsCommands()
+{
+	PRV_CYCLE_COUNTER(STAT_PrvSubsystemFlushPhysicsCommands);
+
+	UWorld* World = GetWorld();
+	FPhysScene* PhysScene = World ? World->GetPhysicsScene() : nullptr;
+	if (PhysScene == nullptr || PhysicsCommandsFrameNumber != GFrameCounter || (PendingPhysicsCommands.Num() == 0 && PendingReactionForces.Num() == 0))
+	{
+		PendingPhysicsCommands.Reset();
+		PendingReactionForces.Reset();
+		ReactionForceIndices.Reset();
+		return;
+	}
+
+	int32 FilteredReactionsNum = 0;
+
+	FPhysicsCommand::ExecuteWrite(PhysScene, [this, PhysScene, &FilteredReactionsNum]()
+	{
+		for (const FPrvPhysicsCommand& Command : PendingPhysicsCommands)
+		{
+			FBodyInstance* BodyInstance = GetSimulatingBody_AssumesLocked(Command.Component.Get());
+			if (BodyInstance == nullptr)
+			{
+				continue;
+			}
+
+			switch (Command.Type)
+			{
+			case EPrvPhysicsCommandType::Force:
+				PhysScene->AddForce_AssumesLocked(BodyInstance, Command.Value, true, false);
+				break;
+
+			case EPrvPhysicsCommandType::Torque:
+				PhysScene->AddTorque_AssumesLocked(BodyInstance, Command.Value, true, false);
+				break;
+
+			case EPrvPhysicsCommandType::AngularVelocity:
+				FPhysicsInterface::SetAngularVelocity_AssumesLocked(BodyInstance->GetPhysicsActorHandle(), FMath::DegreesToRadians(Command.Value));
+				break;
+			}
+		}
+
+		for (const FPrvReactionForce& Reaction : PendingReactionForces)
+		{
+			FBodyInstance* BodyInstance = GetSimulatingBody_AssumesLocked(Reaction.Component.Get());
+			if (BodyInstance == nullptr)
+			{
+				continue;
+			}
+
+			const FPhysicsActorHandle& ActorHandle = BodyInstance->GetPhysicsActorHandle();
+
+			// Light debris isn't pushed by wheels at all
+			if (GPrvVehicleReactionForceMinMass > 0.f && FPhysicsInterface::GetMass_AssumesLocked(ActorHandle) < GPrvVehicleReactionForceMinMass)
+			{
+				FilteredReactionsNum++;
+				continue;
+			}
+
+			// Move torque from the reference point to the center of mass
+			const FVector CenterOfMass = FPhysicsInterface::GetComTransform_AssumesLocked(ActorHandle).GetLocation();
+			const FVector Torque = Reaction.Torque + FVector::CrossProduct(Reaction.ReferencePoint - CenterOfMass, Reaction.Force);
+
+			PhysScene->AddForce_AssumesLocked(BodyInstance, Reaction.Force, true, false);
+			PhysScene->AddTorque_AssumesLocked(BodyInstance, Torque, true, false);
+		}
+	});
+
+	INC_DWORD_STAT_BY(STAT_PrvPhysicsCommands, PendingPhysicsCommands.Num());
+	INC_DWORD_STAT_BY(STAT_PrvReactionForces, PendingReactionForces.Num());
+	INC_DWORD_STAT_BY(STAT_PrvReactionForcesFiltered, FilteredReactionsNum);
+
+	PendingPhysicsCommands.Reset();
+	PendingReactionForces.Reset();
+	ReactionForceIndices.Reset();
+}
+
+//////////////////////////////////////////////////////////////////////////
+// Baked ground
+
+FPrvGroundGrid* UPrvVehicleSubsystem::GetGroundGrid()
+{
+	if (!bGroundGridRequested)
+	{
+		bGroundGridRequested = true;
+
+		UWorld* World = GetWorld();
+		if (World)
+		{
+			const FString MapName = UWorld::RemovePIEPrefix(FPackageName::GetShortName(World->GetOutermost()->GetName()));
+			const FString GridFilePath = FPrvGroundGrid::GetGridFilePath(MapName);
+
+			GroundGrid.SetMaxResidentTiles(GPrvVehicleGroundGridMaxTiles);
+			if (FPaths::FileExists(GridFilePath) && GroundGrid.Open(GridFilePath))
+			{
+				GroundGridMaterials = GroundGrid.GetMaterials();
+			}
+		}
+	}
+
+	return GroundGrid.IsOpen() ? &GroundGrid : nullptr;
+}
@@ -0,0 +1,78 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#include "PrvPlugin.h"
+
+#include "PrvDampingCorrection.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPrvDampingCorrectionTest, "PsRealVehicle.Suspension.DampingCorrectionTables", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+static bool PrvCorrectionNearlyEqual(float Value, float Reference)
+{
+	return FMath::IsNearlyEqual(Value, Reference, FMath::Max(FMath::Abs(Reference) * 1.e-3f, 1.e-6f));
+}
+
+bool FPrvDampingCorrectionTest::RunTest(const FString& Parameters)
+{
+	const float Masses[] = {50.f, 1500.f, 40000.f};
+	const float Stiffnesses[] = {1.e5f, 1.e6f, 4.e6f};
+	const float Dampings[] = {1.e3f, 2.e4f, 1.e5f};
+	const float CorrectionFactors[] = {0.5f, 1.f};
+	const int32 MaxActiveWheelsNum = 16;
+
+	// Off-grid DeltaTime samples over the whole table range
+	const int32 DeltaTimeSamplesNum = 97;
+
+	for (const float Mass : Masses)
+	{
+		for (const float Damping : Dampings)
+		{
+			// Custom correction: one table per (stiffness, damping, mass, factor)
+			for (const float Stiffness : Stiffnesses)
+			{
+				for (const float CorrectionFactor : CorrectionFactors)
+				{
+					FPrvDampingCorrectionTable Table;
+					Table.Build(Stiffness, Damping, Mass, CorrectionFactor);
+
+					for (int32 SampleIdx = 1; SampleIdx <= DeltaTimeSamplesNum; ++SampleIdx)
+					{
+						const float DeltaTime = FPrvDampingCorrectionTable::MaxDeltaTime * SampleIdx / DeltaTimeSamplesNum;
+						const float VelocityScale = Table.GetVelocityScale(DeltaTime);
+						const float ReferenceScale = FPrvDampingCorrection::CalcVelocityScale(Stiffness, Damping, Mass, DeltaTime, CorrectionFactor);
+
+						if (!PrvCorrectionNearlyEqual(VelocityScale, ReferenceScale))
+						{
+							AddError(FString::Printf(TEXT("Velocity scale mismatch (stiffness %f, damping %f, mass %f, factor %f, DeltaTime %f): table %f, closed form %f"),
+								Stiffness, Damping, Mass, CorrectionFactor, DeltaTime, VelocityScale, ReferenceScale));
+						}
+					}
+				}
+			}
+
+			// Adaptive correction: shared table, light masses push the argument above the tabulated range
+			for (int32 ActiveWheelsNum = 1; ActiveWheelsNum <= MaxActiveWheelsNum; ++ActiveWheelsNum)
+			{
+				for (int32 SampleIdx = 1; SampleIdx <= DeltaTimeSamplesNum; ++SampleIdx)
+				{
+					const float DeltaTime = FPrvDampingCorrectionTable::MaxDeltaTime * SampleIdx / DeltaTimeSamplesNum;
+					const float DampingScale = FPrvDampingCorrection::GetAdaptiveDampingScale(Damping, Mass, ActiveWheelsNum, DeltaTime);
+					const float ReferenceScale = FPrvDampingCorrection::CalcAdaptiveDampingScale(Damping, Mass, ActiveWheelsNum, DeltaTime);
+
+					if (!PrvCorrectionNearlyEqual(DampingScale, ReferenceScale))
+					{
+						AddError(FString::Printf(TEXT("Adaptive damping scale mismatch (damping %f, mass %f, active wheels %d, DeltaTime %f): table %f, closed form %f"),
+							Damping, Mass, ActiveWheelsNum, DeltaTime, DampingScale, ReferenceScale));
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
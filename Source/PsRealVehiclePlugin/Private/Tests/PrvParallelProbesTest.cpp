@@ -0,0 +1,169 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#include "PrvPlugin.h"
+
+#include "PrvVehicleMovementComponent.h"
+
+#include "Async/ParallelFor.h"
+#include "Components/BoxComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPrvParallelProbesTest, "PsRealVehicle.Suspension.ParallelProbes", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/** Static box vehicles stand on */
+static void PrvSpawnTestGround(UWorld* World, const FVector& Location, const FRotator& Rotation, const FVector& Extent)
+{
+	AActor* Ground = World->SpawnActor<AActor>();
+	UBoxComponent* Box = NewObject<UBoxComponent>(Ground);
+	Box->SetBoxExtent(Extent);
+	Box->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	Box->SetWorldLocationAndRotation(Location, Rotation);
+	Ground->SetRootComponent(Box);
+	Box->RegisterComponent();
+}
+
+/** Tracked vehicle without mesh asset: wheels are placed by suspension setup only */
+static UPrvVehicleMovementComponent* PrvSpawnTestVehicle(UWorld* World, const FTransform& Transform, int32 WheelsPerTrack)
+{
+	AActor* Owner = World->SpawnActor<AActor>();
+	USkeletalMeshComponent* Mesh = NewObject<USkeletalMeshComponent>(Owner);
+	Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Mesh->SetWorldTransform(Transform);
+	Owner->SetRootComponent(Mesh);
+	Mesh->RegisterComponent();
+
+	UPrvVehicleMovementComponent* Vehicle = NewObject<UPrvVehicleMovementComponent>(Owner);
+	Vehicle->bAsyncSuspensionTrace = false;
+	Vehicle->bBakedGround = false;
+	Vehicle->bShowDebug = false;
+
+	for (int32 TrackIdx = 0; TrackIdx < 2; ++TrackIdx)
+	{
+		for (int32 WheelIdx = 0; WheelIdx < WheelsPerTrack; ++WheelIdx)
+		{
+			FSuspensionInfo SuspInfo;
+			SuspInfo.bInheritWheelBoneTransform = false;
+			SuspInfo.bRightTrack = (TrackIdx == 1);
+			SuspInfo.Location = FVector(-250.f + 500.f * WheelIdx / FMath::Max(1, WheelsPerTrack - 1), (TrackIdx == 1) ? 150.f : -150.f, 0.f);
+			Vehicle->SuspensionSetup.Add(SuspInfo);
+		}
+	}
+
+	Vehicle->SetUpdatedComponent(Mesh);
+	Vehicle->RegisterComponent();
+
+	return Vehicle;
+}
+
+static int32 PrvCountContactMismatches(const FPrvSuspensionSimData& A, const FPrvSuspensionSimData& B)
+{
+	if (A.Num() != B.Num())
+	{
+		return FMath::Max(A.Num(), B.Num());
+	}
+
+	int32 MismatchesNum = 0;
+	for (int32 WheelIdx = 0; WheelIdx < A.Num(); ++WheelIdx)
+	{
+		if (A.Contact[WheelIdx] != B.Contact[WheelIdx] ||
+			A.ContactLength[WheelIdx] != B.ContactLength[WheelIdx] ||
+			!A.ContactLocation[WheelIdx].Equals(B.ContactLocation[WheelIdx], 0.f) ||
+			!A.ContactNormal[WheelIdx].Equals(B.ContactNormal[WheelIdx], 0.f))
+		{
+			MismatchesNum++;
+		}
+	}
+
+	return MismatchesNum;
+}
+
+bool FPrvParallelProbesTest::RunTest(const FString& Parameters)
+{
+	const int32 VehiclesNum = 16;
+	const int32 WheelsPerTrack = 7;
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+
+	// Flat ground with a ramp, so vehicles have wheels on different primitives and in the air
+	PrvSpawnTestGround(World, FVector(0.f, 0.f, -50.f), FRotator::ZeroRotator, FVector(10000.f, 10000.f, 50.f));
+	PrvSpawnTestGround(World, FVector(0.f, 2000.f, 0.f), FRotator(15.f, 0.f, 0.f), FVector(2000.f, 1000.f, 50.f));
+
+	FRandomStream Random(2016);
+
+	TArray<UPrvVehicleMovementComponent*> Vehicles;
+	for (int32 VehicleIdx = 0; VehicleIdx < VehiclesNum; ++VehicleIdx)
+	{
+		const FVector Location(Random.FRandRange(-3000.f, 3000.f), Random.FRandRange(-1000.f, 3000.f), Random.FRandRange(10.f, 120.f));
+		const FRotator Rotation(Random.FRandRange(-10.f, 10.f), Random.FRandRange(-180.f, 180.f), Random.FRandRange(-10.f, 10.f));
+		Vehicles.Add(PrvSpawnTestVehicle(World, FTransform(Rotation, Location), WheelsPerTrack));
+	}
+
+	TArray<FPrvBodySnapshot> Bodies;
+	Bodies.SetNum(VehiclesNum);
+	for (int32 VehicleIdx = 0; VehicleIdx < VehiclesNum; ++VehicleIdx)
+	{
+		UPrvVehicleMovementComponent* Vehicle = Vehicles[VehicleIdx];
+		if (!TestTrue(TEXT("Vehicle is initialized"), Vehicle->UpdatedMesh != nullptr && Vehicle->SuspensionData.Num() == WheelsPerTrack * 2) ||
+			!TestTrue(TEXT("Vehicle can probe wheels in parallel"), Vehicle->CanProbeWheelsInParallel()))
+		{
+			break;
+		}
+
+		Vehicle->CaptureBodySnapshot(Bodies[VehicleIdx]);
+	}
+
+	int32 ContactsNum = 0;
+
+	// Second pass starts from coherence and last contact caches filled by the first one
+	for (int32 PassIdx = 0; PassIdx < 2 && !HasAnyErrors(); ++PassIdx)
+	{
+		TArray<TArray<FSuspensionState>> WheelsBeforeProbes;
+		for (UPrvVehicleMovementComponent* Vehicle : Vehicles)
+		{
+			WheelsBeforeProbes.Add(Vehicle->SuspensionData);
+		}
+
+		ParallelFor(VehiclesNum, [&Vehicles, &Bodies](int32 Index)
+		{
+			Vehicles[Index]->ProbeWheels(Bodies[Index]);
+		});
+
+		for (int32 VehicleIdx = 0; VehicleIdx < VehiclesNum; ++VehicleIdx)
+		{
+			UPrvVehicleMovementComponent* Vehicle = Vehicles[VehicleIdx];
+			const FPrvSuspensionSimData ParallelSim = Vehicle->SuspensionSimData;
+
+			// Serial probes from the same snapshot should find the same contacts
+			TestEqual(FString::Printf(TEXT("Pass %d vehicle %d serial probe mismatches"), PassIdx, VehicleIdx), Vehicle->ValidateProbeWheels(Bodies[VehicleIdx], WheelsBeforeProbes[VehicleIdx]), 0);
+
+			// Validation shouldn't touch live state
+			TestEqual(FString::Printf(TEXT("Pass %d vehicle %d contacts changed by validation"), PassIdx, VehicleIdx), PrvCountContactMismatches(ParallelSim, Vehicle->SuspensionSimData), 0);
+
+			for (int32 WheelIdx = 0; WheelIdx < ParallelSim.Num(); ++WheelIdx)
+			{
+				ContactsNum += ParallelSim.Contact[WheelIdx];
+			}
+		}
+	}
+
+	// Both wheels on the ground and in the air are covered
+	TestTrue(TEXT("Some wheels have contact"), ContactsNum > 0);
+	TestTrue(TEXT("Some wheels have no contact"), ContactsNum < VehiclesNum * WheelsPerTrack * 2 * 2);
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,103 @@
+// Copyright 2016 Pushkin Studio. All Rights Reserved.
+
+#include "PrvPlugin.h"
+
+#include "PrvSuspensionKernel.h"
+#include "PrvSuspensionSimData.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPrvSuspensionKernelTest, "PsRealVehicle.Suspension.SimdKernel", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/** Random wheels with and without contact, compressing and decompressing */
+static void PrvFillSuspensionSimData(FPrvSuspensionSimData& Sim, int32 WheelsNum, FRandomStream& Random)
+{
+	Sim.SetNum(WheelsNum);
+
+	for (int32 Index = 0; Index < WheelsNum; ++Index)
+	{
+		Sim.Length[Index] = Random.FRandRange(10.f, 60.f);
+		Sim.InvLength[Index] = 1.f / Sim.Length[Index];
+		Sim.Stiffness[Index] = Random.FRandRange(1.e5f, 4.e6f);
+		Sim.CompressionDamping[Index] = Random.FRandRange(1.e3f, 1.e5f);
+		Sim.DecompressionDamping[Index] = Random.FRandRange(1.e3f, 1.e5f);
+
+		Sim.Contact[Index] = (Random.FRand() < 0.75f) ? 1 : 0;
+		Sim.ContactLength[Index] = Random.FRandRange(0.f, Sim.Length[Index]);
+		Sim.PreviousLength[Index] = Random.FRandRange(0.f, Sim.Length[Index]);
+	}
+}
+
+static bool PrvKernelNearlyEqual(float A, float B)
+{
+	return FMath::Abs(A - B) <= 1.e-4f * FMath::Max3(1.f, FMath::Abs(A), FMath::Abs(B));
+}
+
+bool FPrvSuspensionKernelTest::RunTest(const FString& Parameters)
+{
+	// Sizes below, at and around the vector width, so the scalar tail is always covered
+	const int32 WheelsNums[] = {1, 3, 4, 5, 7, 13, 18};
+	const float DeltaTime = 1.f / 30.f;
+	const float InvWheelMass = 4.f / 30000.f;
+
+	FRandomStream Random(2016);
+
+	for (const int32 WheelsNum : WheelsNums)
+	{
+		FPrvSuspensionSimData Source;
+		PrvFillSuspensionSimData(Source, WheelsNum, Random);
+
+		// Prepare
+		FPrvSuspensionSimData Vectorized = Source;
+		FPrvSuspensionSimData Reference = Source;
+
+		FPrvSuspensionKernel::PrepareSpringDamper(Vectorized, 1.f / DeltaTime);
+		FPrvSuspensionKernel::PrepareSpringDamperScalar(Reference, 1.f / DeltaTime);
+
+		for (int32 Index = 0; Index < WheelsNum; ++Index)
+		{
+			if (!PrvKernelNearlyEqual(Vectorized.Compression[Index], Reference.Compression[Index]) ||
+				!PrvKernelNearlyEqual(Vectorized.Velocity[Index], Reference.Velocity[Index]) ||
+				!PrvKernelNearlyEqual(Vectorized.Damping[Index], Reference.Damping[Index]))
+			{
+				AddError(FString::Printf(TEXT("Prepare mismatch on wheel %d of %d: compression %f/%f, velocity %f/%f, damping %f/%f"), Index, WheelsNum,
+					Vectorized.Compression[Index], Reference.Compression[Index], Vectorized.Velocity[Index], Reference.Velocity[Index], Vectorized.Damping[Index], Reference.Damping[Index]));
+			}
+		}
+
+		// Solve from the same prepared state: explicit and implicit steps, with and without force clamp
+		const FPrvSuspensionSimData Prepared = Reference;
+		for (const bool bClampForce : {false, true})
+		{
+			for (const float ImplicitDeltaTime : {0.f, DeltaTime})
+			{
+				Vectorized = Prepared;
+				Reference = Prepared;
+
+				FPrvSuspensionKernel::SolveSpringDamper(Vectorized, bClampForce, ImplicitDeltaTime, InvWheelMass);
+				FPrvSuspensionKernel::SolveSpringDamperScalar(Reference, bClampForce, ImplicitDeltaTime, InvWheelMass);
+
+				for (int32 Index = 0; Index < WheelsNum; ++Index)
+				{
+					if (!PrvKernelNearlyEqual(Vectorized.Force[Index], Reference.Force[Index]) ||
+						!PrvKernelNearlyEqual(Vectorized.PreviousLength[Index], Reference.PreviousLength[Index]))
+					{
+						AddError(FString::Printf(TEXT("Solve mismatch on wheel %d of %d (clamp %d, implicit dt %f): force %f/%f, length %f/%f"), Index, WheelsNum, bClampForce, ImplicitDeltaTime,
+							Vectorized.Force[Index], Reference.Force[Index], Vectorized.PreviousLength[Index], Reference.PreviousLength[Index]));
+					}
+
+					if (bClampForce && Vectorized.Force[Index] < 0.f)
+					{
+						AddError(FString::Printf(TEXT("Clamped force is negative on wheel %d of %d: %f"), Index, WheelsNum, Vectorized.Force[Index]));
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -29,8 +29,12 @@ namespace UnrealBuildTool.Rules
             PrivateDependencyModuleNames.AddRange(
                 new string[]
 				{
-					"AnimGraphRuntime"
+					"AnimGraphRuntime",
+					"Landscape"
 				});
+
+			// Landscape layer materials are read from PhysX heightfield shapes
+			SetupModulePhysicsSupport(Target);
 		}
 	}
 }
\ No newline at end of file